@@ -4,12 +4,53 @@
 #include "elapsedMillis.h";
 
 
-#define TXMIT_INTERVAL 5 // ms
+#define TXMIT_INTERVAL 5 // ms; how often the chuck is read
+
+// Transmit on change, otherwise just a heartbeat -- the heartbeat
+// MUST match RADIO_HEARTBEAT on the base.
+#define TXMIT_HEARTBEAT 40      // ms between frames when nothing changes;
+                                // ~48 once asleep; the base holds for two
+#define TXMIT_STICK_THRESHOLD 8 // stick change worth a frame (10-bit units; 2 raw)
+
+// #define BENCHMARKING_SCHEDULE
+
+// Between samples the MCU sleeps: idle while the stick is moving or
+// held, and powered down (watchdog wake, ~16ms) once it's been still
+// at neutral this long
+#define TXMIT_AWAKE 1000        // ms
+// #define BENCHMARKING_POWER   // duty cycle (& datasheet current model), once a minute
+// #define DEBUGGING_TXMIT      // print every sample (keeps the UART busy)
+#include "Sleeper.h"
 
 // #define DEBUGGING_CHUCK
 // #define DEBUGGING_CHUCK_ACTIVITY
-#define WII_ACTIVITY_COUNTER 100  // once per 20ms; 50 per second
-#include "Chuck.h"
+// #define BENCHMARKING_CHUCK
+// #define BENCHMARKING_ACTIVITY
+#define WII_ACTIVITY_MS 160       // frozen this long (and WII_ACTIVITY_READS reads) -> inactive
+#include "Nunchuck.h"
+
+// #define BENCHMARKING_FRAME
+#include "ControlFrame.h"
+
+#define BATTERY_EMPTY_MV 3300     // LiPo, straight to Vcc (no regulator)
+#define BATTERY_FULL_MV 4200
+#define BATTERY_INTERVAL 1000     // ms between battery readings
+
+// Telemetry from the base (TelemetryFrame), shown on the LEDs:
+// board battery green / yellow (both) / red, one flash a second;
+// red flashing fast on a base fault or when the base isn't answering
+#define TELEMETRY_INTERVAL 500    // ms between requests
+#define TELEMETRY_WAIT 3          // ms to listen for the answer
+#define TELEMETRY_TIMEOUT 2000    // ms without an answer: link trouble
+// each TelemetryFrame offers a channel to hop to: echo it, and hop once
+// the base has the echo (ACKed; streaming, once it's sent).  Without
+// telemetry for HOP_HOME ms go back to the pair's own channel (the base
+// goes sooner)
+#define HOP_HOME 1500
+#define GREEN_LED_PIN 5
+#define RED_LED_PIN 6
+// #define DEBUGGING_TELEMETRY
+#include "Blinker.h"
 
 /*-----( Import needed libraries )-----*/
 // SEE http://arduino-info.wikispaces.com/Arduino-Libraries  !!
@@ -18,32 +59,348 @@
 #include <RHReliableDatagram.h>
 #include <RH_NRF24.h>
 #include <SPI.h>
+#include <EEPROM.h>
+
+// Addresses & channel come from pairing (Pairing.h).  Pairing happens
+// on first use, or with C+Z held at power-up; turn the board on first,
+// it only listens for PAIR_WINDOW ms.
+#define EEPROM_PAIR_ADDRESS_ADDY 0
+#define EEPROM_PAIR_BOARD_ADDY 1
+#define EEPROM_PAIR_CHANNEL_ADDY 2
+#define PAIR_TIMEOUT 10000      // ms per attempt
+#include "Pairing.h"
 
-#define CLIENT_ADDRESS 1      // For Radio Link
-#define SERVER_ADDRESS 2
+// Radio link mode -- MUST match the base (see TXRX.h there)
+//   default: RHReliableDatagram, wait for the ACK & retry
+//   RADIO_STREAMING: raw driver, fire-and-forget
+// either way the payload is a ControlFrame, and the answer to a
+// CF_TELEMETRY request is a TelemetryFrame
+// #define RADIO_STREAMING
+#define RADIO_RETRIES 2       // reliable mode: resends before giving up
+#define RADIO_ACK_TIMEOUT 4   // ms to wait for each ACK; less than TXMIT_INTERVAL
+
+// #define BENCHMARKING_RADIO
+
+// Compute split -- MUST match the base (see TXRX.h there)
+//   default: send the stick (ControlFrame); the base runs Throttle.h
+//   TXMIT_THROTTLE: run Throttle.h here and send the finished throttle
+//     (ThrottleFrame); the base only applies the failsafe and the ESC
+// #define TXMIT_THROTTLE
+// #define BENCHMARKING_PIPELINE  // Throttle::update() cost, once a minute
+#ifdef TXMIT_THROTTLE
+  // the base's settings, after the pairing; unset (the base's defaults)
+  // until there's a way to tune them from here
+  #define EEPROM_AUTOCRUISE_ADDY 3
+  #define EEPROM_DRAGBRAKE_ADDY 4
+  #define EEPROM_MAXTHROTTLE_ADDY 5
+  #define EEPROM_ACCELPROFILE_ADDY 6
+  #define THROTTLE_MIN 0.05
+  #define THROTTLE_TICK 20      // ms; how often the pipeline runs (its rates are per second)
+  // this is stupid; when did abs() stop working with floats?
+  #define ABS(X) (X > 0 ? X : -X)
+  #include "utils.h"
+  #include "Throttle.h"
+#endif
 
 // Create an instance of the radio driver
 RH_NRF24 RadioDriver;
 
 // Create an instance of a manager object to manage message delivery and receipt, using the driver declared above
-RHReliableDatagram RadioManager(RadioDriver, CLIENT_ADDRESS);// sets the driver to NRF24 and the client adress to 1
+RHReliableDatagram RadioManager(RadioDriver);  // address from pairing
+
+Pairing pairing;
+
+Nunchuck chuck;
+Sleeper sleeper;
+elapsedMillis sinceChanged;
+Blinker green, red;
+TelemetryFrame telemetry;
+elapsedMillis sinceTelemetry = TELEMETRY_TIMEOUT;
+byte radioChannel;              // what the radio is tuned to
+byte hopTo;                     // offered by the base, to echo; 0: none
+#ifdef TXMIT_THROTTLE
+  Throttle throttle;
+#endif
+
+void radio_tune(byte channel) {
+  RadioDriver.setChannel(channel);
+  radioChannel = channel;
+} // radio_tune(channel)
 
-Chuck chuck;
 
 void setup() {
   Serial.begin(115200);
   chuck.setup();
+  #ifdef BENCHMARKING_CHUCK
+    chuck.benchmarkDecode();
+  #endif
+  #ifdef BENCHMARKING_FRAME
+    benchmarkControlFrame();
+  #endif
+  power_timer1_disable();       // unused; Timer0 (millis), TWI, SPI, UART stay
+  power_timer2_disable();
+  green.init(GREEN_LED_PIN);
+  red.init(RED_LED_PIN);
+  #ifdef TXMIT_THROTTLE
+    throttle.init();
+  #endif
 
   // NOTE: pinMode for Radio pins handled by RadioDriver
-  if (!RadioManager.init())   // Defaults after init are 2.402 GHz (channel 2), 2Mbps, 0dBm
-    Serial.println("init failed");
+  #ifdef RADIO_STREAMING
+    Serial.println(F("Radio: streaming"));
+    if (!RadioDriver.init())    // Defaults after init are 2.402 GHz (channel 2), 2Mbps, 0dBm
+      Serial.println("init failed");
+  #else
+    Serial.println(F("Radio: reliable"));
+    if (!RadioManager.init())   // Defaults after init are 2.402 GHz (channel 2), 2Mbps, 0dBm
+      Serial.println("init failed");
+    RadioManager.setRetries(RADIO_RETRIES);
+    RadioManager.setTimeout(RADIO_ACK_TIMEOUT);
+  #endif
+
+  pairing.readEEPROM();
+  chuck.update();
+  if (! pairing.isPaired() || (chuck.C && chuck.Z)) {
+    Serial.print(F("Pairing Chuck #"));
+    Serial.println(pairing.address);
+    green.high();
+    // a re-pair (C+Z) which times out keeps the old pairing
+    while (! pairing.pair(&RadioDriver, PAIR_TIMEOUT) && ! pairing.isPaired()) {
+      Serial.println(F("Pairing: no answer, still trying"));
+    }
+    green.low();
+  }
+  RadioManager.setThisAddress(pairing.address);  // and the driver's
+  RadioDriver.setHeaderTo(pairing.board);
+  radio_tune(pairing.channel);
+  Serial.print(F("Chuck #"));
+  Serial.print(pairing.address);
+  Serial.print(F(" -> board #"));
+  Serial.print(pairing.board);
+  Serial.print(F(", channel "));
+  Serial.println(pairing.channel);
 } // setup()
 
 
+// measure Vcc against the 1.1V bandgap; returns [0 .. 15]
+byte readBattery(void) {
+  static byte battery = 0;
+  static elapsedMillis lastReading = BATTERY_INTERVAL;
+  if (lastReading >= BATTERY_INTERVAL) {
+    ADMUX = _BV(REFS0) | _BV(MUX3) | _BV(MUX2) | _BV(MUX1);
+    ADCSRA |= _BV(ADSC);
+    while (bit_is_set(ADCSRA, ADSC)) {
+      // ~100us
+    }
+    long mV = 1125300L / ADC;  // 1.1V * 1023 * 1000
+    battery = constrain(map(mV, BATTERY_EMPTY_MV, BATTERY_FULL_MV, 0, 15), 0, 15);
+    lastReading = 0;
+  }
+  return battery;
+} // byte readBattery()
+
+
+#ifdef TXMIT_THROTTLE
+// run the throttle pipeline every THROTTLE_TICK; [-511 .. 511]
+int runThrottle(void) {
+  static elapsedMillis sinceTick = THROTTLE_TICK;
+  static int command = 0;
+  if (sinceTick < THROTTLE_TICK) {
+    return command;
+  }
+  float dt = min((unsigned long)sinceTick, 100) / 1000.0;
+  sinceTick = 0;
+  #ifdef BENCHMARKING_PIPELINE
+    static unsigned long pipelineUS = 0, maxPipelineUS = 0;
+    static word ticks = 0;
+    unsigned long startUS = micros();
+  #endif
+  if (chuck.isActive()) {
+    command = throttle.update(ControlInput(chuck), dt) * THROTTLE_FRAME_SCALE;
+  } else {
+    throttle.zero();            // as the base does on inactivity
+    command = 0;
+  }
+  #ifdef BENCHMARKING_PIPELINE
+    unsigned long tickUS = micros() - startUS;
+    pipelineUS += tickUS;
+    maxPipelineUS = max(maxPipelineUS, tickUS);
+    if (++ticks == 3000) {
+      Serial.print(F("pipeline (split: chuck): avg "));
+      Serial.print(pipelineUS / ticks);
+      Serial.print(F("us, max "));
+      Serial.print(maxPipelineUS);
+      Serial.println(F("us per tick"));
+      pipelineUS = maxPipelineUS = 0;
+      ticks = 0;
+    }
+  #endif
+  return command;
+} // int runThrottle()
+#endif
+
+
+// pack up the chuck's current state (the sequence # is set on send)
+void buildFrame(ControlFrame *frame) {
+  frame->stickX = chuck.frame.joyX << 2;
+  frame->stickY = chuck.frame.joyY << 2;
+  frame->buttons = (chuck.C ? CF_BUTTON_C : 0)
+                 | (chuck.Z ? CF_BUTTON_Z : 0)
+                 | (chuck.isActive() ? CF_ACTIVE : 0);
+  frame->battery = readBattery();
+  #ifdef TXMIT_THROTTLE
+    frame->throttle = runThrottle();
+  #else
+    frame->throttle = 0;
+  #endif
+} // buildFrame(frame)
+
+
+// has anything the base would act on changed since the last frame sent?
+// (battery rides along with the heartbeat)
+bool frameChanged(ControlFrame *frame, ControlFrame *sent) {
+  return frame->buttons != sent->buttons
+         || frame->throttle != sent->throttle
+         || abs((int)frame->stickX - (int)sent->stickX) >= TXMIT_STICK_THRESHOLD
+         || abs((int)frame->stickY - (int)sent->stickY) >= TXMIT_STICK_THRESHOLD;
+} // bool frameChanged(frame, sent)
+
+
+// wait briefly for a TelemetryFrame (and its hop offer); true if a good one arrived
+bool radio_listen(void) {
+  byte buf[TELEMETRY_FRAME_LEN];
+  byte len = sizeof(buf);
+  if (! RadioDriver.waitAvailableTimeout(TELEMETRY_WAIT)) {
+    return false;
+  }
+  byte from;
+  #ifdef RADIO_STREAMING
+    bool received = RadioDriver.recv(buf, &len);
+    from = RadioDriver.headerFrom();
+  #else
+    bool received = RadioManager.recvfrom(buf, &len, &from);  // no ACK for these
+  #endif
+  TelemetryFrame frame;
+  if (! received || from != pairing.board || len != TELEMETRY_FRAME_LEN 
+      || ! decodeTelemetryFrame(buf, &frame)) {
+    return false;
+  }
+  telemetry = frame;
+  sinceTelemetry = 0;
+  if (telemetry.channel >= PAIR_CHANNEL_MIN && telemetry.channel <= PAIR_CHANNEL_MAX
+      && telemetry.channel != radioChannel) {
+    hopTo = telemetry.channel;  // not yet: the base moves when it has the echo
+  }
+  #ifdef DEBUGGING_TELEMETRY
+    Serial.print(F("telemetry: battery "));
+    Serial.print(telemetry.battery);
+    Serial.print(F(", throttle "));
+    Serial.print(telemetry.throttle);
+    Serial.print(F("%, faults "));
+    Serial.print(telemetry.faults, BIN);
+    Serial.print(F(", lost "));
+    Serial.print(telemetry.lost);
+    Serial.print(F(", next channel "));
+    Serial.print(telemetry.channel);
+    Serial.print(F("; p90 latency "));
+    Serial.print(telemetry.latencyMS);
+    Serial.print(F("ms, jitter "));
+    Serial.print(telemetry.jitterMS);
+    Serial.print(F("ms, base "));
+    Serial.print(telemetry.processMS);
+    Serial.println(F("ms"));
+  #endif
+  return true;
+} // bool radio_listen()
+
+
+// send one frame to the base; true if it went (and, if reliable, was ACKed).
+// If asked, listen for telemetry; the radio is then powered down.
+bool radio_send(byte *buf, byte len, bool listen) {
+  unsigned long startUS = micros();
+  #ifdef RADIO_STREAMING
+    bool sent = RadioDriver.send(buf, len) && RadioDriver.waitPacketSent();
+  #else
+    bool sent = RadioManager.sendtoWait(buf, len, pairing.board);
+  #endif
+  if (sent && listen) {
+    radio_listen();
+  }
+  RadioDriver.setModeIdle();    // power down: ~1uA
+  sleeper.radioOn(micros() - startUS);
+  return sent;
+} // bool radio_send(buf, len, listen)
+
+
+// the latest telemetry on the LEDs; only restarts them on a change
+void showTelemetry(void) {
+  static char shown = ' ';
+  char show;
+  if (sinceTelemetry >= TELEMETRY_TIMEOUT || (telemetry.faults & TF_FAILSAFE)) {
+    show = '!';
+  } else if (telemetry.faults & TF_NO_BATTERY || telemetry.battery >= 8) {
+    show = 'G';
+  } else if (telemetry.battery >= 4) {
+    show = 'Y';
+  } else {
+    show = 'R';
+  }
+
+  if (show != shown) {
+    green.stop();
+    red.stop();
+    switch (show) {
+      case '!':
+        red.start(5);
+        break;
+      case 'G':
+        green.start(1);
+        break;
+      case 'Y':
+        green.start(1);
+        red.start(1);
+        break;
+      case 'R':
+        red.start(1);
+        break;
+    }
+    shown = show;
+  }
+  green.run();
+  red.run();
+} // showTelemetry()
+
+
+// a thumb on the stick or a button: keep reading every TXMIT_INTERVAL,
+// since the activity test needs WII_ACTIVITY_READS in WII_ACTIVITY_MS
+bool held(void) {
+  return chuck.C || chuck.Z || abs(chuck.X) > 0.1 || abs(chuck.Y) > 0.1;
+} // bool held()
+
+
+// sleep away the rest of this sample
+void nap(unsigned long loopMS, unsigned long loopUS) {
+  sleeper.awake(micros() - loopUS);
+  if (sinceChanged < TXMIT_AWAKE || held()) {
+    sleeper.idle(loopMS, TXMIT_INTERVAL);
+  } else {
+    sleeper.powerDown();
+  }
+  #ifdef BENCHMARKING_POWER
+    static elapsedMillis reportPeriod = 0;
+    if (reportPeriod >= 60000) {
+      sleeper.report();
+      reportPeriod = 0;
+    }
+  #endif
+} // nap(loopMS, loopUS)
+
+
 void loop() {
-  elapsedMillis timeElapsed = 0;
+  unsigned long loopMS = millis(), loopUS = micros();
   chuck.update();
-  
+
+  #ifdef DEBUGGING_TXMIT
       Serial.print(millis());
       Serial.print(F(": "));
       Serial.print(F("y="));
@@ -52,13 +409,127 @@ void loop() {
       Serial.print(F("c="));
       Serial.print(chuck.C);      
       Serial.print(F(", z="));
-      Serial.println(chuck.Z);
+      Serial.print(chuck.Z);
+      Serial.print(F(", rejects="));
+      Serial.println(chuck.filterStats.shortFrames + chuck.filterStats.implausible 
+                     + chuck.filterStats.jumps);
+  #endif
+
+  #ifdef BENCHMARKING_RADIO
+    static unsigned long sendUS = 0, maxSendUS = 0;
+    static word frames = 0, failures = 0;
+    unsigned long startUS = micros();
+  #endif
+  static ControlFrame lastSent;
+  static byte seq = 0;
+  static elapsedMillis sinceSent = TXMIT_HEARTBEAT;
+  static elapsedMillis sinceRequest = TELEMETRY_INTERVAL;
+  showTelemetry();
+  #ifdef BENCHMARKING_SCHEDULE
+    static elapsedMillis benchPeriod = 0;
+    static word changes = 0, heartbeats = 0;
+    static unsigned long differsMS = 0, maxLatencyMS = 0;
+    static bool differs = false;
+  #endif
 
-  if (! RadioManager.sendto(chuck.status, sizeof(chuck.status), SERVER_ADDRESS)) {
-    Serial.println(F("RadioManager.sendto failed"));
+  ControlFrame frame;
+  buildFrame(&frame);
+  #ifdef BENCHMARKING_SCHEDULE
+    // how long has the base's view differed (at all) from the stick?
+    if (! differs && (frame.buttons != lastSent.buttons
+                      || frame.stickX != lastSent.stickX
+                      || frame.stickY != lastSent.stickY)) {
+      differs = true;
+      differsMS = millis();
+    }
+  #endif
+  bool changed = frameChanged(&frame, &lastSent);
+  if (changed) {
+    sinceChanged = 0;
+  } else if (sinceSent < TXMIT_HEARTBEAT) {
+    nap(loopMS, loopUS);
+    return;
   }
 
-  if (timeElapsed < TXMIT_INTERVAL) {
-    delay(TXMIT_INTERVAL - timeElapsed);
+  if (sinceTelemetry >= HOP_HOME && radioChannel != pairing.channel) {
+    radio_tune(pairing.channel);  // lost the hop schedule
+    hopTo = 0;
+  }
+  frame.seq = seq++;
+  lastSent = frame;
+  sinceSent = 0;
+  // ask for telemetry on whatever frame is going out anyway
+  bool request = sinceRequest >= TELEMETRY_INTERVAL;
+  if (request) {
+    frame.buttons |= CF_TELEMETRY;
+    sinceRequest = 0;
   }
+  // the long form only when there's a hop to confirm or a request,
+  // which is also (~2/s) plenty for the base's latency measurements
+  frame.extras = request || hopTo;
+  frame.stamp = frame.extras ? millis() : 0;
+  frame.hop = frame.extras ? hopTo : 0;
+  #ifdef TXMIT_THROTTLE
+    byte buf[THROTTLE_FRAME_LONG_LEN];
+    byte len = encodeThrottleFrame(&frame, buf);
+  #else
+    byte buf[CONTROL_FRAME_LONG_LEN];
+    byte len = encodeControlFrame(&frame, buf);
+  #endif
+  bool sent = radio_send(buf, len, request);
+  if (! sent) {
+    Serial.println(F("radio_send failed"));
+  } else if (frame.hop) {
+    // the base has the echo: it's moving too (after any telemetry)
+    radio_tune(frame.hop);
+    if (hopTo == frame.hop) {
+      hopTo = 0;
+    }
+  }
+
+  #ifdef BENCHMARKING_SCHEDULE
+    changed ? changes ++ : heartbeats ++;
+    if (differs) {
+      maxLatencyMS = max(maxLatencyMS, millis() - differsMS);
+      differs = false;
+    }
+    if (benchPeriod >= 60000) {
+      // streaming every TXMIT_INTERVAL would be 12000/min, ~5ms latency
+      Serial.print(F("schedule: "));
+      Serial.print(changes + heartbeats);
+      Serial.print(F(" frames/min ("));
+      Serial.print(changes);
+      Serial.print(F(" changes, "));
+      Serial.print(heartbeats);
+      Serial.print(F(" heartbeats), worst input latency "));
+      Serial.print(maxLatencyMS);
+      Serial.println(F("ms"));
+      changes = heartbeats = 0;
+      maxLatencyMS = 0;
+      benchPeriod = 0;
+    }
+  #endif
+  #ifdef BENCHMARKING_RADIO
+    unsigned long frameUS = micros() - startUS;
+    sendUS += frameUS;
+    maxSendUS = max(maxSendUS, frameUS);
+    failures += !sent;
+    if (++frames == 1000) {
+      Serial.print(F("radio_send(): avg "));
+      Serial.print(sendUS / frames);
+      Serial.print(F("us, max "));
+      Serial.print(maxSendUS);
+      Serial.print(F("us, failed "));
+      Serial.print(failures);
+      #ifndef RADIO_STREAMING
+        Serial.print(F(", retransmissions "));
+        Serial.print(RadioManager.retransmissions());
+      #endif
+      Serial.println();
+      sendUS = maxSendUS = 0;
+      frames = failures = 0;
+    }
+  #endif
+
+  nap(loopMS, loopUS);
 }
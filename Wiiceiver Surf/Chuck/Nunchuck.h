@@ -0,0 +1,468 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a skateboard is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ * schematic & parts: http://www.digikey.com/schemeit#t9g
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 12 May 2014
+ *
+ */
+ 
+#ifndef NUNCHUCK_H
+#define NUNCHUCK_H
+
+/*
+ * One fully decoded nunchuck frame.  On the wire (6 bytes):
+ *   [0] stick X, [1] stick Y
+ *   [2], [3], [4] accelerometer X, Y, Z: bits 9..2
+ *   [5] bits 7..2: accelerometer Z, Y, X bits 1..0 (2 each)
+ *       bit 1: C, bit 0: Z (active low)
+ */
+struct ChuckFrame {
+  byte joyX, joyY;              // raw stick, [0 .. 255]
+  word accelX, accelY, accelZ;  // raw accelerometers, [0 .. 1023]
+  byte buttons;                 // CHUCK_FRAME_C | CHUCK_FRAME_Z; 1 == pressed
+};
+#define CHUCK_FRAME_Z B00000001
+#define CHUCK_FRAME_C B00000010
+
+
+// counts of I2C reads thrown away by the frame filter
+struct ChuckFilterStats {
+  word shortFrames;   // fewer (or more) than 6 bytes
+  word implausible;   // all 0x00 / 0xFF, or stick outside WII_STICK_MIN..MAX
+  word jumps;         // moved too far in one read, and not confirmed
+};
+
+
+/*
+ *  A "tiny" Wii Nunchuck class
+ *  Borrows heavily from:
+ *
+ *   Nunchuck -- Use a Wii Nunchuck
+ *   Tim Hirzel http://www.growdown.com
+ * who cites:
+ *
+ * * This file is an adaptation of the code by these authors:
+ * Tod E. Kurt, http://todbot.com/blog/
+ *
+ * The Wii Nunchuck reading code is taken from Windmeadow Labs
+ * http://www.windmeadow.com/node/42
+ *
+ * Conversion to Arduino 1.0 by Danjovic
+ * http://hotbit.blogspot.com
+ *
+ * Included the Fix from Martin Peris by Leopold Klimesch
+ * http://blog.martinperis.com/2011/04/arduino-wiichuck.html
+ *
+ *
+ * Taking all of the above into account, this class is heavily adapted
+ * for the specific usage here: a single-channel (~1.5), activity-sensitive 
+ * controller for an electric skateboard.  I've deliberately removed or not used
+ * a fair amount of the data available from the 'chuck, in the interest of 
+ * keeping memory down for the ATtiny series.
+ *
+ * This is the classic wiiceiver's reader (frame filter, decode, activity
+ * test) without the stick oversampling.  It's shared: the Chuck reads
+ * its own nunchuck with it, and the base a wired one (WiredChuck.h);
+ * keep the copies in Chuck/ and Wiiceiver_Base/ identical.
+ */
+class Nunchuck {
+#ifndef WII_ACTIVITY_MS
+#define WII_ACTIVITY_MS 160           // accelerometers frozen this long -> inactive (< 200ms)
+#endif
+#ifndef WII_ACTIVITY_READS
+#define WII_ACTIVITY_READS 24         // ... across at least this many reads (host/activity)
+#endif
+#ifndef WII_STICK_MIN
+#define WII_STICK_MIN 0               // raw stick values outside this are garbage; a stick
+#define WII_STICK_MAX 255             // that rails reads 0 / 255 at full deflection
+#endif
+#ifndef WII_MAX_STICK_STEP
+#define WII_MAX_STICK_STEP 64         // max believable change per read, raw units
+#define WII_MAX_ACCEL_STEP 64         // ... on the accelerometer high bytes
+#endif
+#define DEFAULT_Y_ZERO 128
+#define DEFAULT_X_ZERO 128
+
+private:
+  byte Y0, Ymin, Ymax, X0, Xmin, Xmax;
+  word lastActivity;
+  byte still[4];                           // accelerometer bytes unchanged ...
+  unsigned long stillMS;                   // ... since
+  byte stillReads;                         // ... for this many reads (up to WII_ACTIVITY_READS)
+  bool moved, quiet;
+  word quietCount;                         // times the chuck went quiet
+#ifdef BENCHMARKING_ACTIVITY
+  unsigned long benchMS, heldReads, heldQuiet;
+#endif
+  byte pending[6];                         // an unconfirmed big jump
+  bool hasPending, hasGood;
+public:
+  byte status[6];
+  float X, Y;
+  bool C, Z;
+  ChuckFrame frame;
+  ChuckFilterStats filterStats;
+
+
+private:
+
+  // a held chuck's accelerometers never sit still for long, even at a
+  // fraction of an LSB of noise; a frozen link or an unplugged chuck
+  // (whose last good frame repeats) reads exactly the same forever.
+  // Every read counts, and every axis must hold -- their sum could
+  // cancel out.  Quiet once none has moved for WII_ACTIVITY_MS and
+  // WII_ACTIVITY_READS reads.
+  void _updateActivity(void) {
+    unsigned long now = millis();
+    byte lsbs = status[5] & B11111100;     // not the buttons
+    if (stillReads == 0 || status[2] != still[0] || status[3] != still[1]
+        || status[4] != still[2] || lsbs != still[3]) {
+      moved = moved || stillReads > 0;
+      memcpy(still, status + 2, 3);
+      still[3] = lsbs;
+      stillMS = now;
+      stillReads = 0;
+    }
+    if (stillReads < WII_ACTIVITY_READS) {
+      stillReads ++;
+    }
+    bool nowQuiet = stillReads == WII_ACTIVITY_READS && now - stillMS >= WII_ACTIVITY_MS;
+    if (nowQuiet && !quiet) {
+      quietCount ++;
+    }
+    quiet = nowQuiet;
+#ifdef BENCHMARKING_ACTIVITY
+    _benchActivity(now);
+#endif
+  } // _updateActivity(void)
+  
+  
+  void _resetActivity(void) {
+    stillReads = 0;
+    moved = quiet = false;
+  } // void _resetActivity()
+
+
+#ifdef BENCHMARKING_ACTIVITY
+  /*
+   * false positives: a stick off center or a button down means a thumb
+   * on the chuck, so any read judged quiet then is wrong.  Once a
+   * minute, print how many held reads were.
+   */
+  void _benchActivity(unsigned long now) {
+    bool held = C || Z || abs(X) > 0.1 || abs(Y) > 0.1;
+    if (held && moved) {
+      heldReads ++;
+      heldQuiet += quiet;
+    }
+    if (now - benchMS >= 60000) {
+      Serial.print(F("Activity: quiet in "));
+      Serial.print(heldQuiet);
+      Serial.print(F(" of "));
+      Serial.print(heldReads);
+      Serial.print(F(" held reads ("));
+      Serial.print(heldReads ? 100.0 * heldQuiet / heldReads : 0, 3);
+      Serial.print(F("% false positives), "));
+      Serial.print(WII_ACTIVITY_MS);
+      Serial.println(F("ms"));
+      benchMS = now;
+      heldReads = heldQuiet = 0;
+    }
+  } // _benchActivity(now)
+#endif
+
+  
+  // a real frame is never all zeros or all ones; the stick range is
+  // only checked if it's been narrowed (for chucks whose rails are garbage)
+  bool _plausible(byte *buf) {
+    byte ones = 0xFF, zeros = 0;
+    for (int i = 0; i < 6; i++) {
+      ones &= buf[i];
+      zeros |= buf[i];
+    }
+    return ones != 0xFF && zeros != 0
+#if WII_STICK_MIN > 0 || WII_STICK_MAX < 255
+      && buf[0] >= WII_STICK_MIN && buf[0] <= WII_STICK_MAX
+      && buf[1] >= WII_STICK_MIN && buf[1] <= WII_STICK_MAX
+#endif
+      ;
+  } // bool _plausible(buf)
+
+
+  // rate-of-change check of buf against a reference frame
+  bool _withinStep(byte *buf, byte *ref) {
+    return abs(buf[0] - ref[0]) <= WII_MAX_STICK_STEP
+      && abs(buf[1] - ref[1]) <= WII_MAX_STICK_STEP
+      && abs(buf[2] - ref[2]) <= WII_MAX_ACCEL_STEP
+      && abs(buf[3] - ref[3]) <= WII_MAX_ACCEL_STEP
+      && abs(buf[4] - ref[4]) <= WII_MAX_ACCEL_STEP;
+  } // bool _withinStep(buf, ref)
+
+
+  /*
+   * validate a freshly read frame of cnt bytes; returns true if it
+   * should replace status[].  A big jump is held back one read: it's
+   * accepted only if the next frame agrees with it.  Otherwise status[]
+   * keeps the last good frame.
+   */
+  bool _acceptFrame(byte *buf, int cnt) {
+    if (cnt != 6) {
+      filterStats.shortFrames ++;
+      return false;
+    }
+    if (! _plausible(buf)) {
+      filterStats.implausible ++;
+      return false;
+    }
+    if (! hasGood || _withinStep(buf, status) 
+        || (hasPending && _withinStep(buf, pending))) {
+      hasGood = true;
+      hasPending = false;
+      return true;
+    }
+    filterStats.jumps ++;
+    memcpy(pending, buf, sizeof(pending));
+    hasPending = true;
+    return false;
+  } // bool _acceptFrame(buf, cnt)
+
+
+  // unpack all 6 bytes of status[] into frame; straight-line, no
+  // branches, so it costs the same every tick
+  void _decodeFrame(void) {
+    byte lsbs = status[5];
+    frame.joyX = status[0];
+    frame.joyY = status[1];
+    frame.accelX = (status[2] << 2) | ((lsbs >> 2) & B00000011);
+    frame.accelY = (status[3] << 2) | ((lsbs >> 4) & B00000011);
+    frame.accelZ = (status[4] << 2) | (lsbs >> 6);
+    frame.buttons = ~lsbs & (CHUCK_FRAME_C | CHUCK_FRAME_Z);
+  } // _decodeFrame(void)
+
+  
+  // tracks the max-observed deflection (high & low)
+  void _selfCalibrateDeflection(void) {
+    byte joyX = frame.joyX;
+    Xmin = min(joyX, Xmin);
+    Xmax = max(joyX, Xmax);
+ 
+    byte joyY = frame.joyY;
+
+    if (joyY < Ymin) {
+      Ymin = joyY;
+    }
+
+    if (joyY > Ymax) {
+      Ymax = joyY;
+    }
+  } // void _selfCalibrateDeflection(void)
+
+
+  void _computeStatus(void) {
+    _decodeFrame();
+    byte joyX = frame.joyX;
+    byte joyY = frame.joyY;
+    _selfCalibrateDeflection();
+    
+    int centeredX = joyX - X0;
+    if (centeredX == 0) {
+      X = 0;
+    } 
+    else if (centeredX > 0) {
+      X = 1.0 * centeredX / (Xmax - X0);
+    } 
+    else {
+      X = -1.0 * centeredX / (Xmin - X0); 
+    }
+    
+    int centeredY = joyY - Y0;
+    if (centeredY == 0) {
+      Y = 0;
+    } 
+    else if (centeredY > 0) {
+      Y = 1.0 * centeredY / (Ymax - Y0);
+    } 
+    else {
+      Y = -1.0 * centeredY / (Ymin - Y0); 
+    }
+
+    C = frame.buttons & CHUCK_FRAME_C;
+    Z = frame.buttons & CHUCK_FRAME_Z;
+    
+#ifdef DEBUGGING_CHUCK_ACTIVITY
+    Serial.print(F("CHUCK: "));
+    for (int i = 0; i < 5; i++) {
+      Serial.print(F(" ["));
+      Serial.print(status[i], DEC);
+      Serial.print(F("]"));
+    }
+    Serial.print(F("; still "));
+    Serial.print(stillReads);
+    Serial.print(F(", quiet #"));
+    Serial.print(quietCount);    
+    Serial.println();
+#endif
+
+
+  } // _computeStatus(void)
+
+
+public:
+
+
+  void calibrateCenter() {
+    Y0 = status[1];
+  } // calibrateCenter()
+
+
+  // setup the nunchuck -- send the initialization sequence & start reading data
+  void setup(void) {
+    X0 = Y0 = 128;
+    Xmin = Ymin = 15;
+    Xmax = Ymax = 200;
+
+#ifdef DEBUGGING_CHUCK
+    Serial.print(millis());
+    Serial.print(F(": Chuck.setup() ..."));
+#endif
+    Wire.begin();
+    Wire.beginTransmission(0x52);       // device address
+    Wire.write(0xF0);
+    Wire.write(0x55);
+    Wire.endTransmission();
+    delay(1);
+    Wire.beginTransmission(0x52);
+    Wire.write(0xFB);
+    Wire.write((uint8_t)0x00);
+    Wire.endTransmission();
+#ifdef DEBUGGING_CHUCK
+    Serial.print(F(" transmitted @ "));
+    Serial.print(millis());
+#endif
+
+    // prime the frame filters, until the accelerometers move (active)
+    _resetActivity();
+    hasGood = hasPending = false;
+    for (int i = 0; i < WII_ACTIVITY_READS && !moved; i++) {
+      update();
+      delay(1);
+    }
+    
+ #ifdef DEBUGGING_CHUCK
+    Serial.print(F("; setup complete @ "));
+    Serial.println(millis());
+#endif   
+  } // void setup(void)
+
+
+  /*
+   * take one reading from the nunchuck: status[] gets the newest good
+   * frame, and the activity test another read.  update() does one; call
+   * this between update()s for more reads (WII_ACTIVITY_READS).
+   */
+  void sample(void) {
+    // TODO: estimate the actual delay required between the request 
+    // & data available on bus
+    // delay(1);
+
+    // read 6 bytes
+    Wire.requestFrom (0x52, 6); // request data from nunchuck
+    byte buf[6];
+    int cnt = 0;
+    while (Wire.available()) {
+      byte b = Wire.read();
+      if (cnt < 6) {
+        buf[cnt] = b;
+      }
+      cnt++;
+    }
+
+    // a rejected frame repeats the last good one
+    if (_acceptFrame(buf, cnt)) {
+      memcpy(status, buf, sizeof(status));
+    }
+#ifdef DEBUGGING_CHUCK_FILTER
+    else {
+      printFilterStats();
+    }
+#endif
+    _updateActivity();
+
+    // send one 0 to initiate transfer
+    Wire.beginTransmission(0x52); 
+    Wire.write(0);         
+    Wire.endTransmission();
+  } // void sample(void)
+
+
+  // update the status[] fields from the nunchuck
+  void update(void) {
+    sample();
+    _computeStatus();
+#ifdef DEBUGGING_CHUCK_ACTIVITY
+   Serial.print(F("Active? "));
+   Serial.println(isActive() ? F("yes") : F("no"));
+#endif
+  } // void update(void)
+
+
+  // is the controller "active" -- being held by a human & reporting
+  // changing values?
+  bool isActive(void) {
+    return moved && !quiet;
+  } // bool isActive(void)
+
+
+  void printFilterStats(void) {
+    Serial.print(F("Chuck rejects: short="));
+    Serial.print(filterStats.shortFrames);
+    Serial.print(F(", implausible="));
+    Serial.print(filterStats.implausible);
+    Serial.print(F(", jumps="));
+    Serial.println(filterStats.jumps);
+  } // printFilterStats()
+
+
+#ifdef BENCHMARKING_CHUCK
+  // time the frame decoder; prints the average cost per decode
+  void benchmarkDecode(void) {
+    byte saved = status[5];
+    unsigned long startUS = micros();
+    for (int i = 0; i < 1000; i++) {
+      status[5] = i;
+      _decodeFrame();
+      asm volatile("" ::: "memory");  // keep every pass
+    }
+    unsigned long elapsedUS = micros() - startUS;
+    status[5] = saved;
+    _decodeFrame();
+    Serial.print(F("Chuck::_decodeFrame(): "));
+    Serial.print(elapsedUS / 1000.0, 3);
+    Serial.println(F(" us per frame"));
+  } // benchmarkDecode()
+#endif
+
+};
+
+#endif
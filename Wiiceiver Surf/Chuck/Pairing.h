@@ -0,0 +1,118 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+#ifndef PAIRING_H
+#define PAIRING_H
+
+#include <EEPROM.h>
+
+#define PAIR_RETRY 50           // ms between requests
+#define PAIR_CHANNEL_MIN 4
+#define PAIR_CHANNEL_MAX 124
+
+
+/*
+ * Pairing: which board this Chuck talks to, and where.
+ *
+ * EEPROM_PAIR_ADDRESS_ADDY: this Chuck's address
+ * EEPROM_PAIR_BOARD_ADDY: the board's address
+ * EEPROM_PAIR_CHANNEL_ADDY: the pair's channel
+ *
+ * ex:
+ *   pairing.readEEPROM();
+ *   if (! pairing.isPaired()) {
+ *     pairing.pair(&RadioDriver, 10000);
+ *   }
+ */
+class Pairing {
+  public:
+    byte address;
+    byte board;
+    byte channel;
+
+
+    void readEEPROM(void) {
+      address = EEPROM.read(EEPROM_PAIR_ADDRESS_ADDY);
+      if (address < PAIR_CHUCK_MIN || address > PAIR_CHUCK_MAX) {
+        randomSeed(analogRead(A2) ^ micros());  // A2 floats
+        address = random(PAIR_CHUCK_MIN, PAIR_CHUCK_MAX + 1);
+        EEPROM.write(EEPROM_PAIR_ADDRESS_ADDY, address);
+      }
+      board = EEPROM.read(EEPROM_PAIR_BOARD_ADDY);
+      channel = EEPROM.read(EEPROM_PAIR_CHANNEL_ADDY);
+    } // readEEPROM()
+
+
+    bool isPaired(void) {
+      return board >= PAIR_BOARD_MIN && board <= PAIR_BOARD_MAX
+             && channel >= PAIR_CHANNEL_MIN && channel <= PAIR_CHANNEL_MAX;
+    } // bool isPaired()
+
+
+    /*
+     * ask any board listening on PAIR_CHANNEL (they do, just after
+     * power-up) until one accepts or timeoutMS passes.  On success the
+     * pair is saved; either way the radio is left on PAIR_CHANNEL with
+     * this Chuck's address.
+     */
+    bool pair(RH_NRF24 *radio, word timeoutMS) {
+      elapsedMillis elapsed = 0;
+      PairFrame frame;
+      byte buf[PAIR_FRAME_LEN];
+
+      radio->setChannel(PAIR_CHANNEL);
+      radio->setThisAddress(address);
+      radio->setHeaderFrom(address);
+      while (elapsed < timeoutMS) {
+        frame.type = PAIR_REQUEST;
+        frame.address = address;
+        frame.channel = 0;
+        encodePairFrame(&frame, buf);
+        radio->setHeaderTo(RH_BROADCAST_ADDRESS);
+        radio->send(buf, sizeof(buf));
+        radio->waitPacketSent();
+
+        byte len = sizeof(buf);
+        if (radio->waitAvailableTimeout(PAIR_RETRY) && radio->recv(buf, &len)
+            && len == PAIR_FRAME_LEN && decodePairFrame(buf, &frame)
+            && frame.type == PAIR_ACCEPT
+            && frame.address >= PAIR_BOARD_MIN && frame.address <= PAIR_BOARD_MAX
+            && frame.channel >= PAIR_CHANNEL_MIN && frame.channel <= PAIR_CHANNEL_MAX) {
+          board = frame.address;
+          channel = frame.channel;
+          EEPROM.write(EEPROM_PAIR_BOARD_ADDY, board);
+          EEPROM.write(EEPROM_PAIR_CHANNEL_ADDY, channel);
+          return true;
+        }
+      }
+      return false;
+    } // bool pair(radio, timeoutMS)
+}; // class Pairing
+
+#endif
@@ -0,0 +1,192 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+#ifndef SLEEPER_H
+#define SLEEPER_H
+
+#include <avr/power.h>
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+
+#define SLEEPER_WDT_MS 16       // WDTO_15MS, nominally; the WDT clock is +/- 10%
+
+// modeled supply current, uA: datasheet typicals at 3.3V, 8MHz, not
+// measured on this board -- adjust for yours, or put a meter on it
+#define POWER_MCU_ACTIVE_UA 4000
+#define POWER_MCU_IDLE_UA 1200
+#define POWER_MCU_DOWN_UA 5       // watchdog running
+#define POWER_RADIO_ON_UA 12000   // TX, or RX waiting for an ACK
+#define POWER_RADIO_DOWN_UA 1
+#define POWER_CHUCK_UA 2500       // the nunchuck itself is never gated
+#define POWER_BATTERY_MAH 500
+
+// Arduino's millis() counter (wiring.c); Timer0 stops in power-down
+extern volatile unsigned long timer0_millis;
+
+
+// the watchdog only wakes us up; nothing to do
+ISR(WDT_vect) {
+} // ISR(WDT_vect)
+
+
+/*
+ * Sleeper: keeps the transmitter asleep between samples.
+ *
+ * idle(): SLEEP_MODE_IDLE; Timer0 wakes us every ms, so millis() & the
+ *   UART keep running.  For short waits.
+ * powerDown(): SLEEP_MODE_PWR_DOWN for one watchdog period; everything
+ *   but the watchdog stops, and millis() is advanced by hand afterward.
+ *
+ * It also keeps time in each state: the duty cycle is measured, and
+ * the current budget (averageUA()) is the POWER_* typicals weighted by
+ * it -- a model, until a meter on the real board says otherwise:
+ *   sleeper.awake(us); sleeper.radioOn(us); sleeper.report();
+ */
+class Sleeper {
+  private:
+    unsigned long awakeUS, idleUS, radioUS;
+    unsigned long downMS;
+    word wakeups;
+
+
+    // watchdog: interrupt only (no reset), ~15ms
+    void _armWatchdog(void) {
+      cli();
+      wdt_reset();
+      MCUSR &= ~(1<<WDRF);
+      WDTCSR |= (1<<WDCE) | (1<<WDE);
+      WDTCSR = (1<<WDIE);       // WDP[3:0] == 0: 2K cycles, 16ms
+      sei();
+    } // _armWatchdog()
+
+
+  public:
+
+    Sleeper() {
+      reset();
+    } // Sleeper()
+
+
+    void reset(void) {
+      awakeUS = idleUS = radioUS = 0;
+      downMS = 0;
+      wakeups = 0;
+    } // reset()
+
+
+    // account for time spent working (including the radio)
+    void awake(unsigned long us) {
+      awakeUS += us;
+    } // awake(us)
+
+
+    // account for time the radio was powered up
+    void radioOn(unsigned long us) {
+      radioUS += us;
+    } // radioOn(us)
+
+
+    // idle until ms have passed since start
+    void idle(unsigned long start, word ms) {
+      unsigned long startUS = micros();
+      set_sleep_mode(SLEEP_MODE_IDLE);
+      while (millis() - start < ms) {
+        sleep_mode();           // next Timer0 tick (or any interrupt)
+      }
+      idleUS += micros() - startUS;
+    } // idle(start, ms)
+
+
+    // power down for one watchdog period
+    void powerDown(void) {
+      Serial.flush();           // the UART stops too
+      byte adcsra = ADCSRA;
+      ADCSRA = 0;               // ADC off: ~100uA
+      _armWatchdog();
+      set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+      cli();
+      sleep_enable();
+      sleep_bod_disable();      // BOD off while asleep: ~20uA
+      sei();
+      sleep_cpu();
+      sleep_disable();
+      wdt_disable();
+      ADCSRA = adcsra;
+
+      // Timer0 was stopped; catch millis() up
+      cli();
+      timer0_millis += SLEEPER_WDT_MS;
+      sei();
+      downMS += SLEEPER_WDT_MS;
+      wakeups ++;
+    } // powerDown()
+
+
+    // modeled average current, in uA (POWER_* x the measured duty cycle)
+    unsigned long averageUA(void) {
+      float totalUS = awakeUS + idleUS + downMS * 1000.0;
+      if (totalUS == 0) {
+        return 0;
+      }
+      float ua = (awakeUS * (float)POWER_MCU_ACTIVE_UA
+                  + idleUS * (float)POWER_MCU_IDLE_UA
+                  + downMS * 1000.0 * POWER_MCU_DOWN_UA
+                  + radioUS * (float)POWER_RADIO_ON_UA
+                  + (totalUS - radioUS) * POWER_RADIO_DOWN_UA) / totalUS;
+      return ua + POWER_CHUCK_UA;
+    } // unsigned long averageUA()
+
+
+    // measured duty cycle & modeled current budget, then start over
+    void report(void) {
+      float totalUS = awakeUS + idleUS + downMS * 1000.0;
+      if (totalUS == 0) {
+        return;
+      }
+      unsigned long ua = averageUA();
+      Serial.print(F("power: awake "));
+      Serial.print(100.0 * awakeUS / totalUS, 1);
+      Serial.print(F("%, idle "));
+      Serial.print(100.0 * idleUS / totalUS, 1);
+      Serial.print(F("%, down "));
+      Serial.print(100.0 * downMS * 1000.0 / totalUS, 1);
+      Serial.print(F("% ("));
+      Serial.print(wakeups);
+      Serial.print(F(" wakeups), radio "));
+      Serial.print(100.0 * radioUS / totalUS, 2);
+      Serial.print(F("%; datasheet model: ~"));
+      Serial.print(ua);
+      Serial.print(F("uA, ~"));
+      Serial.print(POWER_BATTERY_MAH * 1000.0 / ua, 0);
+      Serial.println(F("h per charge"));
+      reset();
+    } // report()
+}; // class Sleeper
+
+#endif
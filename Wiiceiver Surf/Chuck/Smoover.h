@@ -0,0 +1,261 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a skateboard is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ * schematic & parts: http://www.digikey.com/schemeit#t9g
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 12 May 2014
+ *
+ */
+
+#ifndef SMOOVER_H
+#define SMOOVER_H
+
+/*
+ * A class to "smoove" the throttle response.  This is positive only; 
+ * the same class (different instances) is used to smooth throttle or
+ * brake response.
+ *
+ * rise and fall are per second; smoove() takes the time since the last
+ * call, so the loop can run at any rate.
+ *
+ * With a jerk limit (per second^2; 0 == off) the ceiling doesn't jump
+ * straight to "rise" either: its rate ramps up by jerk, and back down in
+ * time to land on the target -- an S-curve launch.  That part is fixed
+ * point (SMOOVER_ONE == 1.0), it runs every tick while accelerating.
+ *
+ * ex:
+ *   Smoover upper(THROTTLE_RISE, THROTTLE_FALL, THROTTLE_SMOOTH, 
+ *                 THROTTLE_MIN_BUMP, THROTTLE_JERK);
+ *   upper.init();
+ *   throttle = upper.smoove(stickY, dt);
+ */
+#define SMOOVER_ONE 65536L            // fixed point 1.0 for the S-curve
+#define SMOOVER_MAX_PROFILE 3.0       // above this (raw input) there's no jerk limit
+ 
+  class Smoover {
+    private:
+      float rise, default_rise, fall, default_fall, exp_factor, min_step;
+      float jerk, default_jerk;
+      float last, ceiling;
+      long riseQ, jerkQ, rateQ;       // S-curve: per s, per s^2; fixed point
+      word carry;                     // S-curve: sub-unit motion, 1/1000ths
+      
+      
+      // one jerk-limited step of the ceiling toward target (> ceiling);
+      // returns the new ceiling
+      float _sCurve(float target, float dt) {
+        long position = ceiling * SMOOVER_ONE;
+        long remaining = (long)(target * SMOOVER_ONE) - position;
+        word dtMS = dt * 1000 + 0.5;
+        long rateStep = jerkQ * dtMS / 1000 + 1;
+        
+        // speed up, unless that's too fast to stop on the target:
+        // rate^2 <= 2 * jerk * remaining (scaled down by 2^12 to fit a long)
+        long rate = rateQ + rateStep;
+        long r = rate >> 6;
+        if (r * r > 2 * (jerkQ >> 6) * (remaining >> 6)) {
+          rate = rateQ - rateStep;
+        }
+        // the floor: never stall just short
+        rateQ = constrain(rate, rateStep, riseQ);
+        
+        long motion = rateQ * dtMS + carry;
+        long step = motion / 1000;
+        carry = motion % 1000;
+        if (step >= remaining) {
+          rateQ = carry = 0;
+          return target;
+        }
+        return (float)(position + step) / SMOOVER_ONE;
+      } // float _sCurve(target, dt)
+      
+      
+    public:
+    
+      // constructor
+      Smoover(float rise_, float fall_, float exp_factor_, float min_step_, 
+              float jerk_ = 0) {
+        default_rise = rise_; 
+        default_fall = fall_; 
+        exp_factor = exp_factor_;
+        min_step = min_step_;
+        default_jerk = jerk_;
+        jerk = 0;
+        zero();
+      } // Smoover(rise, fall, exp_factor, min_step, jerk)
+      
+      
+      // zeroes internal vars (e.g. ceiling)
+      void zero() {
+        last = ceiling = 0;
+        rateQ = carry = 0;
+      } // zero()
+      
+      
+      // initialization: read vars from EEPROM
+      void init(void) {
+        init(getProfileMultiplier());
+      } // init()
+
+
+      // ... or for a given profile multiplier.  Rates scale with it, jerk
+      // with its square: the S-curve takes the same share of every launch
+      void init(float multiplier) {
+        rise = default_rise * multiplier;
+        fall = default_fall * multiplier;
+        jerk = (multiplier > SMOOVER_MAX_PROFILE ? 0 
+                : default_jerk * multiplier * multiplier);
+        riseQ = rise * SMOOVER_ONE;
+        jerkQ = jerk * SMOOVER_ONE;
+        #ifdef DEBUGGING
+          Serial.print(F("Smoother::init(): profileMultiplier="));
+          Serial.print(multiplier);
+          Serial.print(F(", rise="));
+          Serial.print(rise, 4);
+          Serial.print(F(", fall="));
+          Serial.print(fall, 4);
+          Serial.print(F(", jerk="));
+          Serial.println(jerk, 4);
+        #endif
+      } // init(multiplier)
+      
+       
+      /*
+      
+      // return the smooved value for target
+      *
+      * target is (generally) a stick position, [0..1]
+      * the returned value is a "smoothed" throttle, [0..1]
+      * 
+      * GENERALLY:
+      *   if the new value is under something we've seen recently
+      *   (the ceiling) move it quickly -- responsive throttle
+      *   because we're not accelerating hard.
+      *
+      *   if the value is above the ceiling (hard acceleration)
+      *   limit the "rate" of change (acceleration limit "rise")
+      *
+      *   The ceiling "falls" at a fixed rate; ideally this would
+      *   be the rate at which the board slows down naturally
+      *
+      *   with a jerk limit, the ceiling's rise follows an S-curve
+      *   (above); anything else stops it, so the next one starts 
+      *   gently again
+      *
+      * dt is the time (seconds) since the last call
+      */
+      float smoove(float target, float dt) {
+        float riseStep = rise * dt, fallStep = fall * dt;
+        float goal;
+        
+        #ifdef DEBUGGING_SMOOVER
+          if (ceiling > 0) {
+            Serial.print(F("Smoover: c="));
+            Serial.print(ceiling, 4);
+            Serial.print(F(", t="));
+            Serial.print(target, 4);
+          }
+        #endif
+        if (jerk > 0 && target > ceiling) {
+          ceiling = _sCurve(min(target, 1.0), dt);
+          goal = ceiling;
+          #ifdef DEBUGGING_SMOOVER
+            Serial.print(F(" ~^ "));
+          #endif
+        } else if (target > (ceiling + riseStep)) {
+          // increase ceiling as fast as "rise"; goal is pinned here
+          // scale by target: smaller stick motion = smaller rate
+          ceiling += riseStep;  
+          ceiling = min(ceiling, 1.0);
+          goal = ceiling;
+          #ifdef DEBUGGING_SMOOVER
+            if (ceiling > 0) {
+              Serial.print(F(" ^^ "));
+            }
+          #endif
+        } else if (target < (ceiling - fallStep)) {
+          rateQ = carry = 0;
+          // decrease ceiling as fast as "fall"
+          // target is passed through
+          ceiling -= fallStep;
+          ceiling = max(ceiling, 0.0);
+          goal = target;
+          #ifdef DEBUGGING_SMOOVER
+            if (ceiling > 0) {
+              Serial.print(F(" vv "));
+            }
+          #endif
+        } else {
+          rateQ = carry = 0;
+          goal = target;
+          #ifdef DEBUGGING_SMOOVER
+            if (ceiling > 0) {
+              Serial.print(F(" == "));
+            }
+          #endif
+        }
+
+        #ifdef DEBUGGING_SMOOVER
+          if (ceiling > 0) {
+            Serial.print(F(" => c="));
+            Serial.print(ceiling, 4);
+            Serial.print(F(", g="));
+            Serial.println(goal, 4);
+          }
+        #endif
+        
+        return goal;
+      } // float smoove(target, dt)
+
+
+      // as a Pipeline stage
+      float run(float target, float dt) {
+        return smoove(target, dt);
+      } // float run(target, dt)
+
+
+      // opposite of smoove
+      void rough(float goal) {        
+        #ifdef DEBUGGING_SMOOVER
+          if (ceiling > 0) {
+            Serial.print(F("Smoover::rough("));
+            Serial.print(goal, 4);
+            Serial.print(F(") => c="));
+            Serial.print(ceiling, 4);
+          }
+        #endif
+        
+        last = ceiling = goal;
+        rateQ = carry = 0;
+          
+        #ifdef DEBUGGING_SMOOVER
+          if (ceiling > 0) {
+            Serial.print(F("; now c="));
+            Serial.println(ceiling, 4);
+          }
+        #endif
+      } // float rough(goal)
+
+  }; // class Smoove
+  
+#endif
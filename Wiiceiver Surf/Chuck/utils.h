@@ -0,0 +1,90 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+#ifndef UTILS_H
+#define UTILS_H
+
+#include <EEPROM.h>
+
+/*
+ * The settings helpers Throttle.h & co. need, as on the base; only
+ * used with TXMIT_THROTTLE.
+ */
+
+// reads a setting from an EEPROM address, returns that or a default
+// note that uninitialized EEPROM is all ones
+byte readSetting(int eeprom_addy, byte default_value) {
+  Serial.print("reading ");
+  Serial.print(eeprom_addy);
+  byte value = EEPROM.read(eeprom_addy);
+  Serial.print(": ");
+  Serial.println(value);
+  return value == 255 ? default_value : value;
+} // byte readSetting(int eeprom_addy, byte default_value)
+
+
+// the multiplier [0.5 .. zillion] for an acceleration profile (0..6)
+float profileMultiplier(byte accelProfile) {
+    float multiplier = 1.0;
+    
+    switch (accelProfile) {
+      case 0: 
+        multiplier = 0.5;
+        break;
+      case 1:
+        multiplier = 0.75;
+        break;
+      case 3: 
+        multiplier = 1.25;
+        break;
+      case 4:
+        multiplier = 1.5;
+        break;
+      case 5:
+        multiplier = 2.0;
+        break;
+      case 6: // raw input, basically
+        multiplier = 100.0;
+        break;
+      case 2: // FALLTHROUGH
+      default:
+        multiplier = 1.0;
+        break;
+    }
+    return multiplier;
+} // float profileMultiplier(accelProfile)
+
+
+// reads the acceleration profile setting (default: 2) and returns a
+// multiplier [0.5 .. zillion]
+float getProfileMultiplier(void) {
+    return profileMultiplier(readSetting(EEPROM_ACCELPROFILE_ADDY, 2));
+} // float getProfileMultiplier()
+
+#endif
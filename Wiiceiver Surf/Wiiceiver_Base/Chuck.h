@@ -32,6 +32,55 @@
 
 #include "TXRX.h"
 
+#ifdef WIRED_CHUCK
+  #ifdef TXMIT_THROTTLE
+    #error "WIRED_CHUCK needs the throttle pipeline on the base (no TXMIT_THROTTLE)"
+  #endif
+  #include "WiredChuck.h"
+#endif
+
+/*
+ * Input sources: the radio, and with WIRED_CHUCK a nunchuck on the
+ * base's I2C.  INPUT_PRIMARY drives the board while it's usable (a
+ * frame newer than INPUT_FAILOVER ms, flagged CF_ACTIVE); when it
+ * isn't, the other takes over in the same update().  Both feed
+ * _computeStatus().
+ *
+ * A loss can't be seen before the primary's next frame is due, so
+ * INPUT_FAILOVER counts its frames: one lost frame is ridden through,
+ * INPUT_FAILOVER_MISSES in a row switch -- still inside FAILSAFE_HOLD,
+ * so the throttle never decays while there's a source to go to.  Back
+ * to the primary once it's delivered INPUT_RETURN_FRAMES steady frames
+ * (each within INPUT_FAILOVER of the last), so a flapping link doesn't
+ * bounce the board between the two.
+ */
+#define INPUT_RADIO 0
+#define INPUT_WIRED 1
+#define INPUT_SOURCES 2
+#ifndef INPUT_PRIMARY
+#define INPUT_PRIMARY INPUT_RADIO
+#endif
+#if INPUT_PRIMARY == INPUT_RADIO
+  #define INPUT_FRAME_MS (RADIO_HEARTBEAT + 8)  // ~48 once the Chuck naps
+#else
+  #define INPUT_FRAME_MS 20                     // read every loop() tick
+#endif
+#ifndef INPUT_FAILOVER_MISSES
+#define INPUT_FAILOVER_MISSES 2
+#endif
+#ifndef INPUT_FAILOVER
+#define INPUT_FAILOVER (INPUT_FAILOVER_MISSES * INPUT_FRAME_MS + 4)  // ms; + jitter
+#endif
+#ifndef INPUT_RETURN_FRAMES
+#define INPUT_RETURN_FRAMES 3
+#endif
+
+struct InputSource {
+  ControlFrame control;
+  unsigned long receivedMS;     // 0: never heard from
+  bool fresh;                   // not yet used
+};
+
 /*
  *  A "tiny" Wii Nunchuck class
  *  Borrows heavily from:
@@ -61,59 +110,37 @@
  *
  */
 class Chuck {
-#ifndef WII_ACTIVITY_COUNTER
-#define WII_ACTIVITY_COUNTER 250  // consecutive static reads & it's considered inactive
-#endif
 #define DEFAULT_Y_ZERO 128
 #define DEFAULT_X_ZERO 128
 
 private:
-  byte status[6], lastStatus[6];
   byte Y0, Ymin, Ymax, X0, Xmin, Xmax;
-  word lastActivity, activitySamenessCount;
+  word lastActivity;
   elapsedMillis lastUpdate;
+  unsigned long lastPacketMS;              // when the newest frame arrived
+  InputSource sources[INPUT_SOURCES];
+  byte primaryStreak;                      // steady frames from INPUT_PRIMARY
+  unsigned long primaryMS;                 // ... the newest of them
+  #ifdef WIRED_CHUCK
+    WiredChuck wired;
+  #endif
 public:
+  byte source;                             // INPUT_*, driving the board
+  word failovers;
   float X, Y;
   bool C, Z;
+  ControlFrame control;                    // newest frame from the Chuck
 
 
 private:
 
-  bool all255s(void) {
-    for (int i=0; i < 6; i++) {
-      if (status[i] != 255) {
-        return false;
-      }
-    }
-    return true;
-  } // bool all255s(void)
-
-
-  bool statusChanged(void) {
-    for (int i=0; i < 6; i++) {
-      if (status[i] != lastStatus[i]) {
-        return true;
-      }
-    }
-    
-    return false;
-  } // bool statusChanged()
-  
-  
-  void saveLastStatus(void) {
-    for (int i=0; i < 6; i++) {
-      lastStatus[i] = status[i];
-    }
-  } // void saveLastStatus()
-
-  
   // tracks the max-observed deflection (high & low)
   void _selfCalibrateDeflection(void) {
-    byte joyX = status[0];
+    byte joyX = control.stickX >> 2;
     Xmin = min(joyX, Xmin);
     Xmax = max(joyX, Xmax);
  
-    byte joyY = status[1];
+    byte joyY = control.stickY >> 2;
 
     if (joyY < Ymin) {
       Ymin = joyY;
@@ -125,60 +152,118 @@ private:
   } // void _selfCalibrateDeflection(void)
 
 
+  // the stick is 10 bits; calibration (X0, Xmin etc) stays 8 bits.
+  // With TXMIT_THROTTLE there's no stick, only the finished throttle.
   void _computeStatus(void) {
-    byte joyX = status[0];
-    byte joyY = status[1];
+    #ifdef TXMIT_THROTTLE
+    // the Chuck ran the throttle pipeline; Y carries its result
+    X = 0;
+    Y = (float)control.throttle / THROTTLE_FRAME_SCALE;
+    #else
+    int joyX = control.stickX;
+    int joyY = control.stickY;
     _selfCalibrateDeflection();
     
-    int centeredX = joyX - X0;
+    int centeredX = joyX - (X0 << 2);
     if (centeredX == 0) {
       X = 0;
     } 
     else if (centeredX > 0) {
-      X = 1.0 * centeredX / (Xmax - X0);
+      X = 0.25 * centeredX / (Xmax - X0);
     } 
     else {
-      X = -1.0 * centeredX / (Xmin - X0); 
+      X = -0.25 * centeredX / (Xmin - X0); 
     }
     
-    int centeredY = joyY - Y0;
+    int centeredY = joyY - (Y0 << 2);
     if (centeredY == 0) {
       Y = 0;
     } 
     else if (centeredY > 0) {
-      Y = 1.0 * centeredY / (Ymax - Y0);
+      Y = 0.25 * centeredY / (Ymax - Y0);
     } 
     else {
-      Y = -1.0 * centeredY / (Ymin - Y0); 
+      Y = -0.25 * centeredY / (Ymin - Y0); 
     }
+    #endif
+    X = constrain(X, -1.0, 1.0);
+    Y = constrain(Y, -1.0, 1.0);
 
-    C = ((status[5] & B00000010) >> 1) == 0;
-    Z = (status[5] & B00000001) == 0;
+    C = control.buttons & CF_BUTTON_C;
+    Z = control.buttons & CF_BUTTON_Z;
 
+#ifdef DEBUGGING_CHUCK_ACTIVITY
+    Serial.print(F("CHUCK: #"));
+    Serial.print(control.seq);
+    Serial.print(F(" ["));
+    Serial.print(control.stickX);
+    Serial.print(F("] ["));
+    Serial.print(control.stickY);
+    Serial.print(F("]; buttons "));
+    Serial.print(control.buttons, HEX);
+    Serial.print(F(", battery "));
+    Serial.println(control.battery);
+#endif
 
-    if (!statusChanged()) { 
-      if (activitySamenessCount < WII_ACTIVITY_COUNTER) {
-        activitySamenessCount ++;
-      }
+
+  } // _computeStatus(void)
+
+
+  // can source s drive the board?
+  bool _usable(byte s, unsigned long now) {
+    return sources[s].receivedMS != 0 
+           && now - sources[s].receivedMS < INPUT_FAILOVER
+           && (sources[s].control.buttons & CF_ACTIVE);
+  } // bool _usable(s, now)
+
+
+  // count the primary's steady frames since its last gap (or inactivity)
+  void _countPrimary(void) {
+    InputSource *primary = &sources[INPUT_PRIMARY];
+    if (primary->receivedMS == primaryMS) {
+      return;
+    }
+    if (primaryMS != 0 && primary->receivedMS - primaryMS < INPUT_FAILOVER
+        && (primary->control.buttons & CF_ACTIVE)) {
+      primaryStreak = min(primaryStreak + 1, 255);
     } else {
-      activitySamenessCount = 0;
-      saveLastStatus();
+      primaryStreak = 0;
     }
-    
-#ifdef DEBUGGING_CHUCK_ACTIVITY
-    Serial.print(F("CHUCK: "));
-    for (int i = 0; i < 5; i++) {
-      Serial.print(F(" ["));
-      Serial.print(status[i], DEC);
-      Serial.print(F("]"));
+    primaryMS = primary->receivedMS;
+  } // _countPrimary()
+
+
+  // the primary if it's usable (and, coming back to it, has been steady
+  // for a while), else the other if it is, else no change
+  byte _arbitrate(unsigned long now) {
+    byte other = INPUT_SOURCES - 1 - INPUT_PRIMARY;
+    if (_usable(INPUT_PRIMARY, now)
+        && (source == INPUT_PRIMARY || primaryStreak >= INPUT_RETURN_FRAMES
+            || ! _usable(other, now))) {
+      return INPUT_PRIMARY;
+    } else if (_usable(other, now)) {
+      return other;
     }
-    Serial.print(F("; sameness "));
-    Serial.print(activitySamenessCount);    
-    Serial.println();
-#endif
+    return source;
+  } // byte _arbitrate(now)
 
 
-  } // _computeStatus(void)
+  // drive from source s's newest frame
+  void _use(byte s, unsigned long now) {
+    InputSource *input = &sources[s];
+    lastUpdate = now - input->receivedMS;
+    if (s == source && input->fresh && lastPacketMS != 0) {
+      gapLog.log(min(input->receivedMS - lastPacketMS, 65535));
+    }
+    lastPacketMS = input->receivedMS;
+    input->fresh = false;
+    control = input->control;
+    _computeStatus();
+    #ifdef DEBUGGING_CHUCK_ACTIVITY
+      Serial.print(F("Active? "));
+      Serial.println(isActive() ? F("yes") : F("no"));
+    #endif
+  } // _use(s, now)
 
 
 public:
@@ -217,7 +302,7 @@ public:
 
 
   void calibrateCenter() {
-    Y0 = status[1];
+    Y0 = control.stickY >> 2;
   } // calibrateCenter()
 
 
@@ -228,33 +313,12 @@ public:
     Xmax = Ymax = 200;
 
     // radio init; should already be done
-    /*
-    #ifdef DEBUGGING_CHUCK
-        Serial.print(millis());
-        Serial.print(F(": Chuck.setup() ..."));
-    #endif
-    Wire.begin();
-    Wire.beginTransmission(0x52);       // device address
-    Wire.write(0xF0);
-    Wire.write(0x55);
-    Wire.endTransmission();
-    delay(1);
-    Wire.beginTransmission(0x52);
-    Wire.write(0xFB);
-    Wire.write((uint8_t)0x00);
-    Wire.endTransmission();
-    #ifdef DEBUGGING_CHUCK
-        Serial.print(F(" transmitted @ "));
-        Serial.print(millis());
+    #ifdef WIRED_CHUCK
+      wired.setup();
     #endif
-    */
 
-    // REFACTOR -- update() shouldn't run so frequently
-    // do enough updates to prime the activity checker ...
-    for (int i = 0; i < WII_ACTIVITY_COUNTER; i++) {
-      update();
-      delay(1);
-    }
+    // activity is judged by the Chuck itself (CF_ACTIVE); nothing to prime
+    update();
     
      #ifdef DEBUGGING_CHUCK
         Serial.print(F("; setup complete @ "));
@@ -263,59 +327,75 @@ public:
   } // void setup(void)
 
 
-  // update the status[] fields from the nunchuck
-  // ... by receiving a status packet
+  // between ticks: another read of the wired nunchuck, if any, for
+  // its activity test
+  void sample(void) {
+    #ifdef WIRED_CHUCK
+      wired.sample();
+    #endif
+  } // sample()
+
+
+  // update the status fields from the nunchuck
+  // ... by taking the newest packet the radio interrupt queued up (and
+  // reading the wired nunchuck, if any), then picking a source.
+  // Never waits on the radio; if nothing new came in, nothing changes.
   void update(void) {
-    /*
-    // TODO: estimate the actual delay required between the request 
-    // & data available on bus
-    // delay(1);
-
-    // read 6 bytes
-    Wire.requestFrom (0x52, 6); // request data from nunchuck
-    int cnt = 0;
-    while (Wire.available()) {
-      status[cnt] = Wire.read();
-      cnt++;
-    }
-    */
-    
-    byte buf[6]; 
-    byte len = sizeof(buf);
-    byte from;
-    elapsedMillis timeElapsed = 0;
-    while (timeElapsed < 10 && !manager.available()) {
-      // delayMicroseconds(500);
+    RadioFrame packet;
+    #ifndef RADIO_IRQ_PIN
+      radio_drain();  // no IRQ line: poll, but don't wait
+    #endif
+    radio_hopFallback();
+    if (radioQueue.takeNewest(&packet)) {
+      sources[INPUT_RADIO].control = packet.control;
+      sources[INPUT_RADIO].receivedMS = packet.receivedMS;
+      sources[INPUT_RADIO].fresh = true;
     }
-    if (manager.available()) {
-      if (manager.recvfrom(buf, &len, &from)) {
-        #ifdef DEBUGGING_CHUCK
-          Serial.print(F("got packet from : 0x"));
-          Serial.println(from, HEX);
-        #endif 
-        lastUpdate = 0;
-        memcpy(status, buf, sizeof(status));
-        _computeStatus();
-        #ifdef DEBUGGING_CHUCK_ACTIVITY
-          Serial.print(F("Active? "));
-          Serial.println(isActive() ? F("yes") : F("no"));
-        #endif
+    #ifdef WIRED_CHUCK
+      if (wired.read(&sources[INPUT_WIRED].control)) {
+        sources[INPUT_WIRED].receivedMS = millis();
+        sources[INPUT_WIRED].fresh = true;
+      }
+    #endif
 
-      } else {
-        Serial.println(F("FIX ME: __FILE__ recv failed"));
+    unsigned long now = millis();
+    _countPrimary();
+    byte chosen = _arbitrate(now);
+    if (chosen != source) {
+      if (sources[source].receivedMS != 0) {
+        // how long since the one we're leaving was last heard
+        word failoverMS = min(now - sources[source].receivedMS, 65535);
+        #ifdef DEBUGGING_FAILOVER
+          Serial.print(now);
+          Serial.print(chosen == INPUT_WIRED ? F(": input radio -> wired after ") 
+                                             : F(": input wired -> radio after "));
+          Serial.print(failoverMS);
+          Serial.println(F("ms"));
+        #endif
+        failovers ++;
       }
-    } else {
-      Serial.println(F("FIX ME: __FILE__ no data available"));
+      source = chosen;
+      lastPacketMS = 0;         // not a gap in either source
+      _use(source, now);
+    } else if (sources[source].fresh) {
+      _use(source, now);
     }
   } // void update(void)
 
 
   // is the controller "active" -- being held by a human & reporting
-  // changing values?
+  // changing values?  The Chuck decides the second part (it has the 
+  // accelerometers); here it just has to keep reporting.
   bool isActive(void) {
-  return lastUpdate < 100 && activitySamenessCount < WII_ACTIVITY_COUNTER && ! all255s();
+  return lastUpdate < FAILSAFE_TRIP && (control.buttons & CF_ACTIVE);
   } // bool isActive(void)
 
+
+  // ms since the newest frame arrived (see Failsafe.h)
+  unsigned long age(void) {
+    return lastUpdate;
+  } // unsigned long age()
+
 };
 
 #endif
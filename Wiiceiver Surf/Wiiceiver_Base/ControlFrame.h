@@ -0,0 +1,356 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+#ifndef CONTROLFRAME_H
+#define CONTROLFRAME_H
+
+#include <util/crc16.h>
+
+/*
+ * ControlFrame: what the Chuck sends the base, bit-packed into 6 bytes.
+ * (TelemetryFrame, below, goes the other way; PairFrame is for pairing.)
+ * This file is shared: keep the copies in Chuck/ and Wiiceiver_Base/
+ * identical.
+ *
+ *   [0] stick X, bits 9..2
+ *   [1] stick Y, bits 9..2
+ *   [2] bits 7..6: stick X bits 1..0, bits 5..4: stick Y bits 1..0,
+ *       bits 3..0: buttons (CF_*)
+ *   [3] sequence #
+ *   [4] bits 7..4: version, bits 3..0: battery
+ *   [5] CRC-8 (CCITT) of [0..4]
+ *
+ * The link extras ride only on the frames that need them -- a
+ * CF_TELEMETRY request (a couple a second) or a hop being confirmed --
+ * as FRAME_EXTRAS_LEN more bytes before the CRC (the "long" form; the
+ * length tells them apart):
+ *   [5] timestamp, low byte
+ *   [6] timestamp, high byte
+ *   [7] hop: the channel the last TelemetryFrame offered, echoed; 0
+ *       when there's nothing to confirm
+ *   [8] CRC-8 (CCITT) of [0..7]
+ *
+ * Bump CONTROL_FRAME_VERSION on any layout change; the base rejects 
+ * frames it doesn't understand.
+ */
+#define CONTROL_FRAME_VERSION 5
+#define CONTROL_FRAME_LEN 6
+#define FRAME_EXTRAS_LEN 3
+#define CONTROL_FRAME_LONG_LEN (CONTROL_FRAME_LEN + FRAME_EXTRAS_LEN)
+
+#define CF_BUTTON_C B00000001
+#define CF_BUTTON_Z B00000010
+#define CF_ACTIVE   B00000100   // the Chuck's own activity check passes
+#define CF_TELEMETRY B00001000  // please answer with a TelemetryFrame
+
+struct ControlFrame {
+  word stickX, stickY;          // [0 .. 1023]
+  byte buttons;                 // CF_* bits
+  byte seq;
+  byte battery;                 // [0 .. 15]
+  bool extras;                  // the long form: stamp & hop are set
+  word stamp;                   // the Chuck's millis() as it sent, low 16 bits
+  byte hop;                     // the offered channel, echoed; 0: none
+  int throttle;                 // [-511 .. 511]; ThrottleFrame only
+};
+
+
+/*
+ * ThrottleFrame: the ControlFrame's stand-in when the Chuck runs the
+ * throttle pipeline itself (TXMIT_THROTTLE): a finished throttle
+ * instead of the stick, 5 bytes.  Decodes into a ControlFrame, with
+ * the stick centered.
+ *
+ *   [0] throttle, bits 9..2 (signed; [-511 .. 511] is [-1 .. 1])
+ *   [1] bits 7..6: throttle bits 1..0, bits 3..0: buttons (CF_*)
+ *   [2] sequence #
+ *   [3] bits 7..4: version, bits 3..0: battery
+ *   [4] CRC-8 (CCITT) of [0..3]
+ *
+ * with the same extras as the ControlFrame's long form at [4..6].
+ */
+#define THROTTLE_FRAME_LEN 5
+#define THROTTLE_FRAME_LONG_LEN (THROTTLE_FRAME_LEN + FRAME_EXTRAS_LEN)
+#define THROTTLE_FRAME_SCALE 511
+
+
+/*
+ * TelemetryFrame: the base's answer to a CF_TELEMETRY request, 10 bytes.
+ *
+ *   [0] bits 7..4: version, bits 3..0: board battery
+ *   [1] throttle, signed percent [-100 .. 100]
+ *   [2] faults (TF_*)
+ *   [3] link-loss counter, low byte
+ *   [4] link-loss counter, high byte
+ *   [5] channel offered for the next hop; the Chuck echoes it (the
+ *       ControlFrame's hop) and both move once the base has the echo
+ *   [6] one-way radio latency, ms, 90th percentile (LinkTimer.h)
+ *   [7] inter-arrival jitter, ms, 90th percentile
+ *   [8] base processing (arrival to ESC), ms, 90th percentile
+ *   [9] CRC-8 (CCITT) of [0..8]
+ *
+ * Same version rule as the ControlFrame.
+ */
+#define TELEMETRY_FRAME_LEN 10
+
+#define TF_FAILSAFE   B00000001 // the base has given up on the Chuck
+#define TF_NO_BATTERY B00000010 // the base can't measure its battery
+#define TF_CORRUPT    B00000100 // corrupt frames since the last answer
+
+struct TelemetryFrame {
+  byte battery;                 // [0 .. 15]
+  int8_t throttle;              // [-100 .. 100]
+  byte faults;                  // TF_* bits
+  word lost;                    // frames lost since the base started
+  byte channel;                 // offered for the next hop
+  byte latencyMS, jitterMS, processMS;
+};
+
+
+// CRC-8 of all but the last byte of a frame
+byte frameCRC(byte *buf, byte len) {
+  byte crc = 0;
+  for (byte i = 0; i < len - 1; i++) {
+    crc = _crc8_ccitt_update(crc, buf[i]);
+  }
+  return crc;
+} // byte frameCRC(buf, len)
+
+
+// the extras (if frame has them) into buf from at, then the CRC;
+// returns the frame's length
+byte encodeFrameTail(ControlFrame *frame, byte *buf, byte at) {
+  if (frame->extras) {
+    buf[at++] = lowByte(frame->stamp);
+    buf[at++] = highByte(frame->stamp);
+    buf[at++] = frame->hop;
+  }
+  buf[at] = frameCRC(buf, at + 1);
+  return at + 1;
+} // byte encodeFrameTail(frame, buf, at)
+
+
+// check a frame of len bytes whose short form is shortLen, with its
+// version in buf[versionAt]; then the extras (or none) into frame
+bool decodeFrameTail(byte *buf, byte len, byte shortLen, byte versionAt, 
+                     ControlFrame *frame) {
+  if ((len != shortLen && len != shortLen + FRAME_EXTRAS_LEN)
+      || buf[len - 1] != frameCRC(buf, len) || buf[versionAt] >> 4 != CONTROL_FRAME_VERSION) {
+    return false;
+  }
+  frame->extras = len != shortLen;
+  frame->stamp = frame->extras ? word(buf[shortLen], buf[shortLen - 1]) : 0;
+  frame->hop = frame->extras ? buf[shortLen + 1] : 0;
+  return true;
+} // bool decodeFrameTail(buf, len, shortLen, versionAt, frame)
+
+
+// pack frame into buf[CONTROL_FRAME_LONG_LEN]; returns the length
+byte encodeControlFrame(ControlFrame *frame, byte *buf) {
+  buf[0] = frame->stickX >> 2;
+  buf[1] = frame->stickY >> 2;
+  buf[2] = (frame->stickX & B00000011) << 6
+         | (frame->stickY & B00000011) << 4
+         | (frame->buttons & B00001111);
+  buf[3] = frame->seq;
+  buf[4] = CONTROL_FRAME_VERSION << 4 | (frame->battery & B00001111);
+  return encodeFrameTail(frame, buf, 5);
+} // byte encodeControlFrame(frame, buf)
+
+
+// unpack len bytes of buf into frame; false on a bad length, CRC or
+// version (frame's extras may have been touched)
+bool decodeControlFrame(byte *buf, byte len, ControlFrame *frame) {
+  if (! decodeFrameTail(buf, len, CONTROL_FRAME_LEN, 4, frame)) {
+    return false;
+  }
+  frame->stickX = buf[0] << 2 | buf[2] >> 6;
+  frame->stickY = buf[1] << 2 | (buf[2] >> 4 & B00000011);
+  frame->buttons = buf[2] & B00001111;
+  frame->seq = buf[3];
+  frame->battery = buf[4] & B00001111;
+  frame->throttle = 0;
+  return true;
+} // bool decodeControlFrame(buf, len, frame)
+
+
+// pack frame into buf[THROTTLE_FRAME_LONG_LEN]; only the throttle,
+// buttons, seq, battery and extras go.  Returns the length.
+byte encodeThrottleFrame(ControlFrame *frame, byte *buf) {
+  word throttle = frame->throttle;  // two's complement; 10 bits of it
+  buf[0] = throttle >> 2;
+  buf[1] = (throttle & B00000011) << 6 | (frame->buttons & B00001111);
+  buf[2] = frame->seq;
+  buf[3] = CONTROL_FRAME_VERSION << 4 | (frame->battery & B00001111);
+  return encodeFrameTail(frame, buf, 4);
+} // byte encodeThrottleFrame(frame, buf)
+
+
+// unpack len bytes of buf into frame; false on a bad length, CRC or
+// version (frame's extras may have been touched)
+bool decodeThrottleFrame(byte *buf, byte len, ControlFrame *frame) {
+  if (! decodeFrameTail(buf, len, THROTTLE_FRAME_LEN, 3, frame)) {
+    return false;
+  }
+  int throttle = buf[0] << 2 | buf[1] >> 6;
+  frame->throttle = throttle >= 512 ? throttle - 1024 : throttle;
+  frame->stickX = frame->stickY = 512;
+  frame->buttons = buf[1] & B00001111;
+  frame->seq = buf[2];
+  frame->battery = buf[3] & B00001111;
+  return true;
+} // bool decodeThrottleFrame(buf, len, frame)
+
+
+// pack frame into buf[TELEMETRY_FRAME_LEN]
+void encodeTelemetryFrame(TelemetryFrame *frame, byte *buf) {
+  buf[0] = CONTROL_FRAME_VERSION << 4 | (frame->battery & B00001111);
+  buf[1] = frame->throttle;
+  buf[2] = frame->faults;
+  buf[3] = lowByte(frame->lost);
+  buf[4] = highByte(frame->lost);
+  buf[5] = frame->channel;
+  buf[6] = frame->latencyMS;
+  buf[7] = frame->jitterMS;
+  buf[8] = frame->processMS;
+  buf[9] = frameCRC(buf, TELEMETRY_FRAME_LEN);
+} // encodeTelemetryFrame(frame, buf)
+
+
+// unpack buf into frame; false (and frame untouched) on a bad CRC or
+// an unknown version
+bool decodeTelemetryFrame(byte *buf, TelemetryFrame *frame) {
+  if (buf[9] != frameCRC(buf, TELEMETRY_FRAME_LEN) || buf[0] >> 4 != CONTROL_FRAME_VERSION) {
+    return false;
+  }
+  frame->battery = buf[0] & B00001111;
+  frame->throttle = buf[1];
+  frame->faults = buf[2];
+  frame->lost = word(buf[4], buf[3]);
+  frame->channel = buf[5];
+  frame->latencyMS = buf[6];
+  frame->jitterMS = buf[7];
+  frame->processMS = buf[8];
+  return true;
+} // bool decodeTelemetryFrame(buf, frame)
+
+
+/*
+ * PairFrame: pairing, broadcast on PAIR_CHANNEL.  The Chuck asks
+ * (PAIR_REQUEST, with its address); the base answers (PAIR_ACCEPT,
+ * with its address and the channel the pair will use from then on).
+ *
+ *   [0] bits 7..4: version, bits 3..0: type
+ *   [1] sender's address
+ *   [2] channel (PAIR_ACCEPT only)
+ *   [3] CRC-8 (CCITT) of [0..2]
+ *
+ * Chucks take addresses PAIR_CHUCK_MIN .. PAIR_CHUCK_MAX, boards 
+ * PAIR_BOARD_MIN .. PAIR_BOARD_MAX; each picks one at random the first
+ * time it pairs.
+ */
+#define PAIR_FRAME_LEN 4
+
+#define PAIR_REQUEST 1
+#define PAIR_ACCEPT 2
+
+#define PAIR_CHANNEL 2          // RH_NRF24's default
+#define PAIR_CHUCK_MIN 1
+#define PAIR_CHUCK_MAX 100
+#define PAIR_BOARD_MIN 101
+#define PAIR_BOARD_MAX 200
+
+struct PairFrame {
+  byte type;                    // PAIR_REQUEST || PAIR_ACCEPT
+  byte address;                 // of the sender
+  byte channel;
+};
+
+
+// pack frame into buf[PAIR_FRAME_LEN]
+void encodePairFrame(PairFrame *frame, byte *buf) {
+  buf[0] = CONTROL_FRAME_VERSION << 4 | (frame->type & B00001111);
+  buf[1] = frame->address;
+  buf[2] = frame->channel;
+  buf[3] = frameCRC(buf, PAIR_FRAME_LEN);
+} // encodePairFrame(frame, buf)
+
+
+// unpack buf into frame; false (and frame untouched) on a bad CRC or
+// an unknown version
+bool decodePairFrame(byte *buf, PairFrame *frame) {
+  if (buf[3] != frameCRC(buf, PAIR_FRAME_LEN) || buf[0] >> 4 != CONTROL_FRAME_VERSION) {
+    return false;
+  }
+  frame->type = buf[0] & B00001111;
+  frame->address = buf[1];
+  frame->channel = buf[2];
+  return true;
+} // bool decodePairFrame(buf, frame)
+
+
+#ifdef BENCHMARKING_FRAME
+// round-trip random frames; prints mismatches, corruption caught by the
+// CRC, and the cost of an encode + decode; every 4th frame is long
+void benchmarkControlFrame(void) {
+  ControlFrame in, out;
+  byte buf[CONTROL_FRAME_LONG_LEN];
+  word mismatches = 0, caught = 0;
+  unsigned long elapsedUS = 0;
+  for (int i = 0; i < 1000; i++) {
+    in.stickX = random(1024);
+    in.stickY = random(1024);
+    in.buttons = random(16);
+    in.seq = random(256);
+    in.battery = random(16);
+    in.extras = i % 4 == 0;
+    in.stamp = in.extras ? random(65536) : 0;
+    in.hop = in.extras ? random(256) : 0;
+    unsigned long startUS = micros();
+    byte len = encodeControlFrame(&in, buf);
+    bool ok = decodeControlFrame(buf, len, &out);
+    elapsedUS += micros() - startUS;
+    if (!ok || in.stickX != out.stickX || in.stickY != out.stickY
+        || in.buttons != out.buttons || in.seq != out.seq || in.battery != out.battery 
+        || in.extras != out.extras || in.stamp != out.stamp || in.hop != out.hop) {
+      mismatches ++;
+    }
+    buf[random(len)] ^= 1 << random(8);  // one bit flip
+    caught += !decodeControlFrame(buf, len, &out);
+  }
+  Serial.print(F("ControlFrame: 1000 round trips, "));
+  Serial.print(mismatches);
+  Serial.print(F(" mismatched, "));
+  Serial.print(caught);
+  Serial.print(F(" of 1000 bit flips caught; "));
+  Serial.print(elapsedUS / 1000.0, 2);
+  Serial.println(F(" us per encode + decode"));
+} // benchmarkControlFrame()
+#endif
+
+#endif
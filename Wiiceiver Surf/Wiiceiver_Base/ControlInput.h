@@ -0,0 +1,60 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+#ifndef CONTROLINPUT_H
+#define CONTROLINPUT_H
+
+/*
+ * ControlInput: what the throttle needs from a Chuck -- the stick and
+ * the buttons -- as a small read-only snapshot, to pass by const
+ * reference instead of copying the whole Chuck every tick.
+ *
+ * Any class with X, Y, C and Z will do as the source.  This file is
+ * shared: keep the copies in Wiiceiver/, Wiiceiver Surf/Chuck/ and
+ * Wiiceiver Surf/Wiiceiver_Base/ identical.
+ *
+ * ex:
+ *   throttle.update(ControlInput(chuck), dt);
+ *   throttle.update(ControlInput(0, 1.0, false, false), dt);  // full stick
+ */
+struct ControlInput {
+  const float X, Y;
+  const bool C, Z;
+
+  ControlInput(float X_, float Y_, bool C_, bool Z_) 
+    : X(X_), Y(Y_), C(C_), Z(Z_) {
+  } // ControlInput(X, Y, C, Z)
+
+  template <typename Source> 
+  explicit ControlInput(const Source& chuck) 
+    : X(chuck.X), Y(chuck.Y), C(chuck.C), Z(chuck.Z) {
+  } // ControlInput(chuck)
+}; // struct ControlInput
+
+#endif
@@ -155,11 +155,11 @@ class Cruiser {
     } // init()    
     
     
-    // "coast" at idle; decrement the cruise return
-    void coast() {
+    // "coast" at idle, dt seconds; decrement the cruise return
+    void coast(float dt) {
       previous = 0;
-      cr.coast(fall/2);
-    } // coast
+      cr.coast(fall/2 * dt);
+    } // coast(dt)
     
     
     void zero() {
@@ -169,7 +169,8 @@ class Cruiser {
 
 
 
-    float update(float throttle, float stickX, float stickY) {
+    // rise and fall are per second; dt is the time since the last update
+    float update(float throttle, float stickX, float stickY, float dt) {
       // first, update the state
       if (stickY > 0.25) {
         state = CR_ACCEL;
@@ -211,7 +212,7 @@ class Cruiser {
           if (previous < THROTTLE_MIN) {
             previous = throttle;
           }
-          newThrottle = previous + rise * 4;
+          newThrottle = previous + rise * 4 * dt;
           newThrottle = min(newThrottle, 1.0);
           cr.update();  // update the time, but not the level
           #ifdef DEBUGGING_CRUISER
@@ -224,12 +225,12 @@ class Cruiser {
         }
       } else if (state == CR_ACCEL) {
         // advance throttle a little
-        newThrottle = max(previous, throttle) + stickY * rise;
+        newThrottle = max(previous, throttle) + stickY * rise * dt;
         newThrottle = min(newThrottle, 1.0);
         cr.update(newThrottle);
       } else if (state == CR_DECEL) {
         // drop throttle a little (sticky < 0)
-        newThrottle = min(previous, throttle) + stickY * fall;
+        newThrottle = min(previous, throttle) + stickY * fall * dt;
         newThrottle = max(newThrottle, 0.0);
         cr.update(newThrottle);
       } else if (state == CR_NORMAL) {
@@ -243,13 +244,19 @@ class Cruiser {
       #endif 
       
       return previous = newThrottle;
-    } // float update(float throttle, float stickX, float stickY)
+    } // float update(float throttle, float stickX, float stickY, float dt)
     
 
     float getAutoCruise(void) {
       return autoCruise;
     } // float getAutoCruise()
 
+
+    // as of the last update(): still catching up to a cruise return?
+    bool isReturning(void) {
+      return state == CR_RETURNING;
+    } // bool isReturning()
+
 }; // class Cruiser
 
 
@@ -0,0 +1,137 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+#ifndef FAILSAFE_H
+#define FAILSAFE_H
+
+/*
+ * Graduated failsafe: what the base does with the throttle while
+ * the Chuck's frames aren't arriving, by the age of the newest one.
+ *
+ *   < FAILSAFE_HOLD: hold; keep running the throttle on the last
+ *     frame
+ *   < FAILSAFE_TRIP: decay; ease the throttle (or brake) toward 0 by
+ *     FAILSAFE_RAMP per second
+ *   after that: trip; chuck.isActive() fails -> handleInactivity()
+ *
+ * Heartbeats are ~48ms apart once the Chuck naps, so HOLD covers two
+ * of them plus jitter: one lost frame never touches the throttle.
+ * TRIP is the <200ms budget for noticing a dead Chuck; the decay in
+ * between takes at most 0.08 off before the cut, so it only softens
+ * the step a trip would make.
+ */
+#ifndef FAILSAFE_HOLD
+#define FAILSAFE_HOLD 110       // ms; 2 * 48 + jitter
+#endif
+#ifndef FAILSAFE_TRIP
+#define FAILSAFE_TRIP 190       // ms; dead link -> cut in < 200
+#endif
+#ifndef FAILSAFE_RAMP
+#define FAILSAFE_RAMP 1.0       // per second: full throttle -> 0 in 1s
+#endif
+
+#define FAILSAFE_HOLDING 0
+#define FAILSAFE_DECAYING 1
+#define FAILSAFE_TRIPPED 2
+
+byte failsafeStage(unsigned long ageMS) {
+  if (ageMS < FAILSAFE_HOLD) {
+    return FAILSAFE_HOLDING;
+  } else if (ageMS < FAILSAFE_TRIP) {
+    return FAILSAFE_DECAYING;
+  }
+  return FAILSAFE_TRIPPED;
+} // byte failsafeStage(ageMS)
+
+
+/*
+ * GapLog: every gap between frames long enough to leave "hold" is
+ * printed with its length when it ends, and counted here, so the
+ * thresholds above can be tuned from real rides.
+ *
+ * buckets: < FAILSAFE_HOLD (not logged), < 150, < FAILSAFE_TRIP,
+ *   < 500, < 2000, longer
+ */
+#define GAP_BUCKETS 6
+
+class GapLog {
+  private:
+    word counts[GAP_BUCKETS];
+
+
+    byte _bucket(word gapMS) {
+      if (gapMS < FAILSAFE_HOLD) {
+        return 0;
+      } else if (gapMS < 150) {
+        return 1;
+      } else if (gapMS < FAILSAFE_TRIP) {
+        return 2;
+      } else if (gapMS < 500) {
+        return 3;
+      } else if (gapMS < 2000) {
+        return 4;
+      }
+      return 5;
+    } // byte _bucket(gapMS)
+
+
+  public:
+
+    GapLog() {
+      for (byte i = 0; i < GAP_BUCKETS; i++) {
+        counts[i] = 0;
+      }
+    } // GapLog()
+
+
+    // a frame arrived gapMS after the one before it
+    void log(word gapMS) {
+      byte bucket = _bucket(gapMS);
+      counts[bucket] ++;
+      if (bucket > 0) {
+        Serial.print(millis());
+        Serial.print(F(": link gap "));
+        Serial.print(gapMS);
+        Serial.println(gapMS < FAILSAFE_TRIP ? F("ms (decayed)") : F("ms (tripped)"));
+      }
+    } // log(gapMS)
+
+
+    void print(void) {
+      Serial.print(F("Link gaps (held/<150/decayed/<500/<2000/more ms): "));
+      for (byte i = 0; i < GAP_BUCKETS; i++) {
+        Serial.print(counts[i]);
+        Serial.print(i < GAP_BUCKETS - 1 ? F("/") : F("\n"));
+      }
+    } // print()
+}; // class GapLog
+
+GapLog gapLog;
+
+#endif
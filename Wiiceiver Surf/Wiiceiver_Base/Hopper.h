@@ -0,0 +1,225 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+#ifndef HOPPER_H
+#define HOPPER_H
+
+#define HOP_CHANNELS 16         // in the hop table
+#define HOP_MIN_FRAMES 8        // frames on a channel before judging it
+#define HOP_BAD_LOSS 25         // % of frames lost which benches a channel
+#define HOP_BENCH_HOPS 60       // hops a bad channel sits out (~30s)
+
+
+/*
+ * Hopper: the board's side of the hop schedule.
+ *
+ * The table is HOP_CHANNELS of the pairing channels, in an order
+ * seeded from the board's pairing address; the pair's own channel is
+ * always the first ("home").  The board picks each hop and offers it
+ * to the Chuck (TelemetryFrame.channel), so the Chuck never needs the
+ * table.  Nobody moves on the offer alone: the Chuck echoes it
+ * (ControlFrame.hop), and the hop happens when the board has the echo.
+ *
+ * Losses are charged to the channel the board is on.  A channel which
+ * loses HOP_BAD_LOSS% or more of its frames during a visit is skipped
+ * for the next HOP_BENCH_HOPS hops.
+ *
+ * ex:
+ *   hopper.init(pairing.address, pairing.channel);
+ *   hopper.heard(lost);              // per frame
+ *   telemetry.channel = hopper.offer();
+ *   ...
+ *   hopper.hop(control.hop);         // echoed: judge this channel, move on
+ */
+class Hopper {
+  private:
+    byte channels[HOP_CHANNELS];
+    byte benched[HOP_CHANNELS];       // hops left to sit out
+    byte visitHeard, visitLost;       // on the current channel, this visit
+    byte current, previous;           // indexes into channels[]
+    byte offered;                     // ditto; == current when none
+    #ifdef BENCHMARKING_HOP
+      word totalHeard[HOP_CHANNELS], totalLost[HOP_CHANNELS];
+    #endif
+
+
+    // a small deterministic PRNG (xorshift), independent of random()
+    word _shuffle(word *state) {
+      *state ^= *state << 7;
+      *state ^= *state >> 9;
+      *state ^= *state << 8;
+      return *state;
+    } // word _shuffle(state)
+
+
+    // the index of channel in the table, or HOP_CHANNELS
+    byte _find(byte channel) {
+      byte i = 0;
+      while (i < HOP_CHANNELS && channels[i] != channel) {
+        i ++;
+      }
+      return i;
+    } // byte _find(channel)
+
+
+  public:
+
+    void init(byte seed, byte home) {
+      byte pool[PAIR_CHANNELS];
+      word state = 0xACE1 ^ (seed << 8 | seed);
+      for (byte i = 0; i < PAIR_CHANNELS; i++) {
+        pool[i] = PAIR_CHANNEL_MIN + 2 * i;
+      }
+      // partial Fisher-Yates: the first HOP_CHANNELS of a shuffle
+      for (byte i = 0; i < HOP_CHANNELS; i++) {
+        byte j = i + _shuffle(&state) % (PAIR_CHANNELS - i);
+        byte swap = pool[i];
+        pool[i] = pool[j];
+        pool[j] = swap;
+        channels[i] = pool[i];
+      }
+      // home goes first (replacing itself if it was drawn later)
+      for (byte i = 1; i < HOP_CHANNELS; i++) {
+        if (channels[i] == home) {
+          channels[i] = channels[0];
+        }
+      }
+      channels[0] = home;
+
+      for (byte i = 0; i < HOP_CHANNELS; i++) {
+        benched[i] = 0;
+        #ifdef BENCHMARKING_HOP
+          totalHeard[i] = totalLost[i] = 0;
+        #endif
+      }
+      current = previous = offered = 0;
+      visitHeard = visitLost = 0;
+    } // init(seed, home)
+
+
+    byte channel(void) {
+      return channels[current];
+    } // byte channel()
+
+
+    byte previousChannel(void) {
+      return channels[previous];
+    } // byte previousChannel()
+
+
+    byte home(void) {
+      return channels[0];
+    } // byte home()
+
+
+    // what the last offer() offered; the current channel if nothing's out
+    byte offeredChannel(void) {
+      return channels[offered];
+    } // byte offeredChannel()
+
+
+    // a frame arrived, after lost others
+    void heard(byte lost) {
+      visitHeard = min(visitHeard + 1, 255);
+      visitLost = min(visitLost + lost, 255);
+      #ifdef BENCHMARKING_HOP
+        totalHeard[current] ++;
+        totalLost[current] += lost;
+      #endif
+    } // heard(lost)
+
+
+    // the Chuck turned up on channel (after a missed hop): follow it
+    void follow(byte channel) {
+      byte i = _find(channel);
+      if (i < HOP_CHANNELS && i != current) {
+        previous = current;
+        current = offered = i;
+        visitHeard = visitLost = 0;
+      }
+    } // follow(channel)
+
+
+    // the next channel along that isn't benched; the same answer until
+    // hop() (or follow())
+    byte offer(void) {
+      if (offered == current) {
+        for (byte step = 1; step <= HOP_CHANNELS; step++) {
+          byte candidate = (current + step) % HOP_CHANNELS;
+          if (benched[candidate] == 0 || step == HOP_CHANNELS) {
+            offered = candidate;
+            break;
+          }
+        }
+      }
+      return channels[offered];
+    } // byte offer()
+
+
+    // the Chuck has confirmed channel: judge the current one, move on.
+    // false (and nothing) if channel isn't in the table, or is current.
+    bool hop(byte channel) {
+      byte i = _find(channel);
+      if (i == HOP_CHANNELS || i == current) {
+        return false;
+      }
+      word frames = visitHeard + visitLost;
+      if (frames >= HOP_MIN_FRAMES && visitLost * 100 >= HOP_BAD_LOSS * frames) {
+        benched[current] = HOP_BENCH_HOPS;
+      }
+      for (byte b = 0; b < HOP_CHANNELS; b++) {
+        if (benched[b] > 0) {
+          benched[b] --;
+        }
+      }
+      previous = current;
+      current = offered = i;
+      visitHeard = visitLost = 0;
+      return true;
+    } // bool hop(channel)
+
+
+    #ifdef BENCHMARKING_HOP
+    // per-channel frames heard / lost; * == benched
+    void printStats(void) {
+      Serial.print(F("hop:"));
+      for (byte i = 0; i < HOP_CHANNELS; i++) {
+        Serial.print(F(" "));
+        Serial.print(channels[i]);
+        Serial.print(benched[i] ? F("*") : F("="));
+        Serial.print(totalHeard[i]);
+        Serial.print(F("/"));
+        Serial.print(totalLost[i]);
+      }
+      Serial.println();
+    } // printStats()
+    #endif
+}; // class Hopper
+
+#endif
@@ -0,0 +1,200 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+#ifndef LINKTIMER_H
+#define LINKTIMER_H
+
+#define TIMING_BUCKETS 8        // 0, 1, 2-3, 4-7 .. 32-63, 64+ ms
+#define TIMING_HALVE 512        // samples; then every count is halved
+#define LINK_TIMER_WINDOW 8     // timed frames per clock-offset window
+#define LINK_TIMER_GAP 1200     // ms; timed frames further apart: no jitter
+
+
+/*
+ * TimingHistogram: a rolling histogram of times in ms, in powers of 2.
+ * Every TIMING_HALVE samples the counts are halved, so old samples
+ * fade out instead of drowning out new ones.
+ */
+class TimingHistogram {
+  private:
+    word counts[TIMING_BUCKETS];
+    word samples;
+
+
+  public:
+
+    TimingHistogram() {
+      for (byte i = 0; i < TIMING_BUCKETS; i++) {
+        counts[i] = 0;
+      }
+      samples = 0;
+    } // TimingHistogram()
+
+
+    void add(word ms) {
+      byte bucket = 0;
+      while (ms > 0 && bucket < TIMING_BUCKETS - 1) {
+        ms >>= 1;
+        bucket ++;
+      }
+      counts[bucket] ++;
+      if (++samples == TIMING_HALVE) {
+        for (byte i = 0; i < TIMING_BUCKETS; i++) {
+          counts[i] >>= 1;
+        }
+        samples = 0;
+      }
+    } // add(ms)
+
+
+    // the top of the bucket holding the pct'th percentile, in ms
+    byte percentile(byte pct) {
+      word total = 0, seen = 0;
+      for (byte i = 0; i < TIMING_BUCKETS; i++) {
+        total += counts[i];
+      }
+      word want = ((unsigned long)total * pct + 99) / 100;
+      for (byte i = 0; i < TIMING_BUCKETS - 1; i++) {
+        seen += counts[i];
+        if (seen >= want) {
+          return (1 << i) - 1;
+        }
+      }
+      return 255;
+    } // byte percentile(pct)
+
+
+    void print(void) {
+      for (byte i = 0; i < TIMING_BUCKETS; i++) {
+        Serial.print(counts[i]);
+        Serial.print(i < TIMING_BUCKETS - 1 ? F("/") : F("\n"));
+      }
+    } // print()
+}; // class TimingHistogram
+
+
+/*
+ * LinkTimer: where the time goes between the stick and the ESC.
+ *
+ *   latency: one-way, Chuck to base.  The Chuck stamps its long
+ *     frames (every telemetry request, ~2/s; see ControlFrame.h) with
+ *     its millis(); arrival - stamp is the latency plus the
+ *     (unknown) offset between the two clocks.  The smallest value
+ *     seen, over this window of LINK_TIMER_WINDOW frames and the last,
+ *     is taken as the offset -- so this is the latency above the
+ *     fastest recent frame, which is mostly air time (~1ms).  Windows
+ *     (a few seconds) keep clock drift out of it.
+ *   jitter: how much later (or earlier) a timed frame arrived than its
+ *     spacing from the one before at the Chuck
+ *   processing: arrival to ESC.setLevel(), on the base: waiting for
+ *     the 20ms tick plus the throttle pipeline
+ *
+ * arrived() runs in the receive path (maybe the radio interrupt), and
+ * owns latency & jitter; processed() runs from loop() and owns
+ * processing, whose 90th percentile it keeps in processP90 for the
+ * receive path to read.  The 90th percentiles go back to the Chuck in
+ * every TelemetryFrame.
+ *
+ * ex:
+ *   if (control.extras) linkTimer.arrived(control.stamp, millis());
+ *   linkTimer.processed(chuck.age());
+ */
+class LinkTimer {
+  private:
+    word offset, windowOffset;  // min(arrival - stamp): last window, this one
+    word windowFrames;
+    word lastArrival, lastStamp;
+    bool started;
+
+
+  public:
+    TimingHistogram latency, jitter, processing;
+    byte processP90;            // processing.percentile(90), as of the last processed()
+
+
+    LinkTimer() {
+      started = false;
+      processP90 = 0;
+    } // LinkTimer()
+
+
+    // a frame stamped stampMS (Chuck's clock) arrived at arrivalMS
+    void arrived(word stampMS, unsigned long arrivalMS) {
+      word now = arrivalMS;
+      word sample = now - stampMS;
+      if (! started) {
+        offset = windowOffset = sample;
+        windowFrames = 0;
+        started = true;
+      } else if ((int)(now - lastArrival) < LINK_TIMER_GAP) {
+        int late = (int)(now - lastArrival) - (int)(stampMS - lastStamp);
+        jitter.add(abs(late));
+      }
+      lastArrival = now;
+      lastStamp = stampMS;
+
+      if ((int)(sample - windowOffset) < 0) {
+        windowOffset = sample;
+      }
+      if ((int)(sample - offset) < 0) {
+        offset = sample;
+      }
+      if (++windowFrames == LINK_TIMER_WINDOW) {
+        offset = windowOffset;
+        windowOffset = sample;
+        windowFrames = 0;
+      }
+      latency.add(sample - offset);
+    } // arrived(stampMS, arrivalMS)
+
+
+    // the ESC got a frame which arrived ageMS ago
+    void processed(unsigned long ageMS) {
+      processing.add(min(ageMS, 255));
+      processP90 = processing.percentile(90);
+    } // processed(ageMS)
+
+
+    // from loop(); the receive path's histograms are copied with it held off
+    void print(void) {
+      noInterrupts();
+      TimingHistogram latencyNow = latency, jitterNow = jitter;
+      interrupts();
+      Serial.print(F("Link timing (0/1/<4/<8/<16/<32/<64/more ms) latency: "));
+      latencyNow.print();
+      Serial.print(F("  jitter: "));
+      jitterNow.print();
+      Serial.print(F("  processing: "));
+      processing.print();
+    } // print()
+}; // class LinkTimer
+
+LinkTimer linkTimer;
+
+#endif
@@ -0,0 +1,151 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+#ifndef PAIRING_H
+#define PAIRING_H
+
+#include <EEPROM.h>
+
+#define PAIR_BITMAP_LEN (PAIR_CHUCK_MAX / 8 + 1)
+#define PAIR_CHANNEL_MIN 4      // 2Mbps: every other channel
+#define PAIR_CHANNEL_MAX 124
+#define PAIR_CHANNELS ((PAIR_CHANNEL_MAX - PAIR_CHANNEL_MIN) / 2 + 1)
+#define PAIR_SCAN_SAMPLES 32    // carrier checks per candidate channel
+
+#define RH_NRF24_REG_09_RPD 0x09    // received power > -64dBm
+
+
+/*
+ * Pairing: which Chucks this board listens to, and where.
+ *
+ * EEPROM_PAIR_ADDRESS_ADDY: this board's address
+ * EEPROM_PAIR_CHANNEL_ADDY: the channel for all its Chucks
+ * EEPROM_PAIR_CHUCKS_ADDY: PAIR_BITMAP_LEN bytes, one bit per Chuck
+ *   address; uninitialized EEPROM (all ones) is treated as empty
+ *
+ * isPaired() is a bit test, cheap enough for the receive interrupt.
+ */
+class Pairing {
+  private:
+    byte chucks[PAIR_BITMAP_LEN];
+
+
+  public:
+    byte address;
+    byte channel;
+
+
+    void readEEPROM(void) {
+      address = EEPROM.read(EEPROM_PAIR_ADDRESS_ADDY);
+      if (address < PAIR_BOARD_MIN || address > PAIR_BOARD_MAX) {
+        randomSeed(analogRead(A2) ^ micros());  // A2 floats
+        address = random(PAIR_BOARD_MIN, PAIR_BOARD_MAX + 1);
+        EEPROM.write(EEPROM_PAIR_ADDRESS_ADDY, address);
+      }
+      channel = EEPROM.read(EEPROM_PAIR_CHANNEL_ADDY);
+      bool blank = channel == 255;
+      for (byte i = 0; i < PAIR_BITMAP_LEN; i++) {
+        chucks[i] = blank ? 0 : EEPROM.read(EEPROM_PAIR_CHUCKS_ADDY + i);
+      }
+    } // readEEPROM()
+
+
+    // is this Chuck address one of ours?
+    bool isPaired(byte from) {
+      return from >= PAIR_CHUCK_MIN && from <= PAIR_CHUCK_MAX
+             && (chucks[from >> 3] & (1 << (from & 7)));
+    } // bool isPaired(from)
+
+
+    // remember a Chuck, and the channel; the whole bitmap is written
+    // since the first time, the rest of it is still all ones
+    void add(byte chuck) {
+      chucks[chuck >> 3] |= 1 << (chuck & 7);
+      for (byte i = 0; i < PAIR_BITMAP_LEN; i++) {
+        if (EEPROM.read(EEPROM_PAIR_CHUCKS_ADDY + i) != chucks[i]) {
+          EEPROM.write(EEPROM_PAIR_CHUCKS_ADDY + i, chucks[i]);
+        }
+      }
+      EEPROM.write(EEPROM_PAIR_CHANNEL_ADDY, channel);
+    } // add(chuck)
+
+
+    bool hasChannel(void) {
+      return channel >= PAIR_CHANNEL_MIN && channel <= PAIR_CHANNEL_MAX;
+    } // bool hasChannel()
+
+
+    /*
+     * pick a channel for this board: start from a spot derived from
+     * its address (so boards spread out even if they all scan at once),
+     * take the first channel with no carrier, or the quietest.
+     * Leaves the radio on PAIR_CHANNEL.
+     */
+    void chooseChannel(Radio *radio) {
+      byte best = 0, bestHits = 255;
+      byte start = (address * 17) % PAIR_CHANNELS;
+      for (byte i = 0; i < PAIR_CHANNELS && bestHits > 0; i++) {
+        byte candidate = PAIR_CHANNEL_MIN + 2 * ((start + i) % PAIR_CHANNELS);
+        radio->setChannel(candidate);
+        radio->setModeRx();
+        byte hits = 0;
+        for (byte sample = 0; sample < PAIR_SCAN_SAMPLES; sample++) {
+          delayMicroseconds(200);  // RPD needs 170us in RX
+          hits += radio->spiReadRegister(RH_NRF24_REG_09_RPD) & 1;
+        }
+        if (hits < bestHits) {
+          best = candidate;
+          bestHits = hits;
+        }
+      }
+      radio->setChannel(PAIR_CHANNEL);
+      channel = best;
+      #ifdef DEBUGGING_PAIRING
+        Serial.print(F("Pairing: chose channel "));
+        Serial.print(channel);
+        Serial.print(F(" ("));
+        Serial.print(bestHits);
+        Serial.println(F(" carrier hits)"));
+      #endif
+    } // chooseChannel(radio)
+
+
+    // how many Chucks are paired
+    byte count(void) {
+      byte n = 0;
+      for (byte i = 0; i < PAIR_BITMAP_LEN; i++) {
+        for (byte b = chucks[i]; b; b &= b - 1) {
+          n ++;
+        }
+      }
+      return n;
+    } // byte count()
+}; // class Pairing
+
+#endif
@@ -0,0 +1,110 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+/*
+ * Pipeline<Stage, Stage, ...>: throttle shaping as a chain of stages,
+ * each one's output the next one's input.  It's all templates: no
+ * virtual calls, no table of stages, the compiler lays the chain out as
+ * straight-line code.  Each product's shaping is a typedef, next to
+ * the stages it uses: SkatePipeline in Smoother.h, SurfPipeline in
+ * Throttle.h.
+ *
+ * A stage is any class with
+ *   float run(float x, float dt);   // dt: seconds since the last run
+ *   void zero(void);                // forget any state
+ *
+ * This file is shared: keep the copies in Wiiceiver/, Wiiceiver Surf/Chuck/
+ * and Wiiceiver Surf/Wiiceiver_Base/ identical.
+ *
+ * ex:
+ *   typedef Pipeline<Curve, Smoover, Clamp> SurfPipeline;
+ *   SurfPipeline gas(Curve(THROTTLE_MIN, 0), Smoover(...), Clamp(0, 1));
+ *   gas.get<Clamp>().set(0, maxThrottle);
+ *   throttle = gas.run(chuck.Y, dt);
+ */
+template <typename Stage> struct PipelineTag {};
+
+template <typename... Stages> class Pipeline;
+
+template <> class Pipeline<> {
+  protected:
+    void _get(void);
+
+  public:
+    float run(float x, float dt) {
+      return x;
+    } // float run(x, dt)
+
+    void zero(void) {
+    } // zero()
+}; // class Pipeline<>
+
+
+template <typename First, typename... Rest>
+class Pipeline<First, Rest...> : public Pipeline<Rest...> {
+  private:
+    First stage;
+
+  protected:
+    using Pipeline<Rest...>::_get;
+    First& _get(PipelineTag<First>) {
+      return stage;
+    } // First& _get(tag)
+
+  public:
+    Pipeline(void) {
+    } // Pipeline()
+
+
+    Pipeline(const First& first, const Rest&... rest) 
+      : Pipeline<Rest...>(rest...), stage(first) {
+    } // Pipeline(first, rest...)
+
+
+    float run(float x, float dt) {
+      return Pipeline<Rest...>::run(stage.run(x, dt), dt);
+    } // float run(x, dt)
+
+
+    void zero(void) {
+      stage.zero();
+      Pipeline<Rest...>::zero();
+    } // zero()
+
+
+    // a stage, by type (one of each per pipeline)
+    template <typename Stage> Stage& get(void) {
+      return _get(PipelineTag<Stage>());
+    } // Stage& get<Stage>()
+}; // class Pipeline<First, Rest...>
+
+#endif
@@ -0,0 +1,113 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+#ifndef RADIOQUEUE_H
+#define RADIOQUEUE_H
+
+#include "ControlFrame.h"
+
+#define RADIO_QUEUE_SIZE 8      // power of 2; holds SIZE-1 frames
+
+struct RadioFrame {
+  ControlFrame control;         // decoded & CRC-checked
+  unsigned long receivedMS;     // millis() when it came off the radio
+};
+
+
+/*
+ * RadioQueue: a single-producer / single-consumer queue of frames.
+ * The producer is the radio interrupt, the consumer is loop().
+ *
+ * No locks: only the producer writes head, only the consumer writes
+ * tail, and each is a single byte (atomic on AVR).  The producer never
+ * fills the slot just behind tail, so the consumer can copy out a frame
+ * while the interrupt keeps adding new ones.
+ *
+ * ex (producer):
+ *   RadioFrame *frame = queue.reserve();
+ *   if (frame) { ... fill it ...; queue.commit(); }
+ *
+ * ex (consumer):
+ *   RadioFrame frame;
+ *   if (queue.takeNewest(&frame)) { ... }
+ */
+class RadioQueue {
+  private:
+    RadioFrame frames[RADIO_QUEUE_SIZE];
+    volatile byte head, tail;
+    volatile word overruns;     // frames dropped because the queue was full
+
+
+    byte next(byte i) {
+      return (i + 1) & (RADIO_QUEUE_SIZE - 1);
+    } // byte next(i)
+
+
+  public:
+
+    RadioQueue() {
+      head = tail = 0;
+      overruns = 0;
+    } // RadioQueue()
+
+
+    // producer: the next free slot, or NULL if the queue is full
+    RadioFrame* reserve(void) {
+      if (next(head) == tail) {
+        overruns ++;
+        return NULL;
+      }
+      return &frames[head];
+    } // RadioFrame* reserve()
+
+
+    // producer: publish the slot from reserve()
+    void commit(void) {
+      head = next(head);
+    } // commit()
+
+
+    // consumer: copy out the newest frame and discard everything older;
+    // false if there was nothing new.  Constant time.
+    bool takeNewest(RadioFrame *frame) {
+      byte h = head;
+      if (h == tail) {
+        return false;
+      }
+      *frame = frames[(h - 1) & (RADIO_QUEUE_SIZE - 1)];
+      tail = h;
+      return true;
+    } // bool takeNewest(frame)
+
+
+    word getOverruns(void) {
+      return overruns;
+    } // word getOverruns()
+}; // class RadioQueue
+
+#endif
@@ -0,0 +1,86 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+#ifndef RAMREPORT_H
+#define RAMREPORT_H
+
+/*
+ * RAM high-water marks, AVR only: ramPaint() fills the free RAM between
+ * the heap and the stack with a pattern, early in setup(); later the 
+ * report counts how much of it the stack never reached (its worst-case
+ * headroom), and how big the heap got.
+ *
+ * ex:
+ *   ramPaint();           // first thing in setup()
+ *   ...
+ *   ramReport();          // every so often
+ */
+#define RAM_PAINT 0xC5
+#define RAM_PAINT_MARGIN 32     // bytes below the current stack left alone
+
+extern char __heap_start, *__brkval;
+
+
+// the top of the heap (or its start, if nothing was allocated)
+char* _ramHeapEnd(void) {
+  return __brkval ? __brkval : &__heap_start;
+} // char* _ramHeapEnd()
+
+
+void ramPaint(void) {
+  char here;
+  for (char *p = _ramHeapEnd(); p < &here - RAM_PAINT_MARGIN; p++) {
+    *p = RAM_PAINT;
+  }
+} // ramPaint()
+
+
+// bytes between the heap and the deepest the stack has been
+word ramHeadroom(void) {
+  char here;
+  word headroom = 0;
+  for (char *p = _ramHeapEnd(); p < &here && *p == RAM_PAINT; p++) {
+    headroom ++;
+  }
+  return headroom;
+} // word ramHeadroom()
+
+
+void ramReport(void) {
+  char here;
+  Serial.print(F("RAM: heap "));
+  Serial.print(_ramHeapEnd() - &__heap_start);
+  Serial.print(F(" bytes, free now "));
+  Serial.print(&here - _ramHeapEnd());
+  Serial.print(F(", stack headroom (worst) "));
+  Serial.print(ramHeadroom());
+  Serial.println(F(" bytes"));
+} // ramReport()
+
+#endif
@@ -0,0 +1,181 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+#ifndef SPEEDHOLD_H
+#define SPEEDHOLD_H
+
+/*
+ * TUNABLES (SPEED_HOLD): the gains are integers, throttle in 1/1000
+ * (per mille) against speed in m/s:
+ *   KP: per mille of throttle per m/s of error
+ *   KI: per mille per m/s, per second it lasts
+ *   KD: per mille per m/s^2 of the wheel's own acceleration; the
+ *     halls are coarse, leave it small
+ */
+#ifndef SPEED_HOLD_KP
+  #define SPEED_HOLD_KP     500
+  #define SPEED_HOLD_KI     400
+  #define SPEED_HOLD_KD     0
+#endif
+#define SPEED_HOLD_MIN    1500    // mm/s; slower than this, C is the plain cruise
+#define SPEED_HOLD_ACCEL  1000    // mm/s per second: full stick, or catching up
+#define SPEED_HOLD_BRAKE  0.25    // the most brake it will hold a descent with
+#define SPEED_HOLD_ERROR  10000L  // mm/s; the error's clamped to this
+
+
+/*
+ * SpeedHold: closed-loop cruise; C holds a speed rather than a
+ * throttle, so it climbs hills and drag-brakes down them.
+ *
+ * Integer PID on wheel speed (WheelSpeed.h), all in mm/s, ms and
+ * millionths of throttle; float only at the edges (and the setpoint,
+ * which creeps by fractions of a mm/s at fast loop rates).  Anti-windup: the
+ * I term is clamped to the output range and doesn't grow while the
+ * output's pinned in the direction of the error.  D works on the
+ * measured speed, so setpoint steps don't kick it.
+ *
+ * The C gestures are Cruiser's: engage takes the current speed (or a
+ * speed released within CRUISER_RETURN ms, when that's faster), the
+ * stick raises / lowers it, and the setpoint moves toward it at
+ * SPEED_HOLD_ACCEL -- which is what makes a return "returning".
+ *
+ * ex:
+ *   if (hold.isEngaged() || hold.engage(throttle, speed)) {
+ *     throttle = hold.update(speed, chuck.Y, dt);
+ *   }
+ *   ...
+ *   hold.release();                 // C let go
+ */
+class SpeedHold {
+  private:
+    float desired, setpoint;          // mm/s: asked for, and ramping to it
+    long iTerm;                       // millionths of throttle
+    long lo, hi;                      // output limits, millionths
+    word lastSpeed;
+    bool engaged;
+    unsigned long releasedMS;
+
+
+  public:
+
+    SpeedHold() {
+      desired = 0;
+      releasedMS = 0;
+      engaged = false;
+      setLimit(1.0);
+    } // SpeedHold()
+
+
+    void setLimit(float maxThrottle) {
+      hi = maxThrottle * 1000000L;
+      lo = -SPEED_HOLD_BRAKE * 1000000L;
+    } // setLimit(maxThrottle)
+
+
+    // take over at speed (mm/s), from throttle: bumpless, the I term
+    // starts where the throttle is.  false (and nothing) if too slow.
+    bool engage(float throttle, word speed) {
+      if (speed < SPEED_HOLD_MIN) {
+        return false;
+      }
+      if (desired <= speed || millis() - releasedMS > CRUISER_RETURN) {
+        desired = speed;
+      }
+      setpoint = speed;
+      lastSpeed = speed;
+      iTerm = constrain((long)(throttle * 1000000L), lo, hi);
+      engaged = true;
+      #ifdef DEBUGGING_SPEEDHOLD
+        Serial.print(F("SpeedHold: engaged at "));
+        Serial.print(speed);
+        Serial.print(F("mm/s, holding "));
+        Serial.println(desired);
+      #endif
+      return true;
+    } // bool engage(throttle, speed)
+
+
+    void release(void) {
+      if (engaged) {
+        engaged = false;
+        releasedMS = millis();
+      }
+    } // release()
+
+
+    bool isEngaged(void) {
+      return engaged;
+    } // bool isEngaged()
+
+
+    bool isReturning(void) {
+      return engaged && setpoint < desired;
+    } // bool isReturning()
+
+
+    // speed in mm/s, stickY the C gesture; returns throttle [-1 .. 1]
+    float update(word speed, float stickY, float dt) {
+      float step = SPEED_HOLD_ACCEL * dt;
+      if (stickY > 0.25 || stickY < -0.25) {
+        desired = max(desired + stickY * step, 0);
+        setpoint = desired;
+      } else if (setpoint < desired) {
+        setpoint = min(setpoint + step, desired);
+      } else {
+        setpoint = desired;
+      }
+
+      long dtMS = max((long)(dt * 1000), 1);
+      long error = constrain((long)setpoint - (long)speed, -SPEED_HOLD_ERROR, SPEED_HOLD_ERROR);
+      long pTerm = SPEED_HOLD_KP * error;
+      long dTerm = SPEED_HOLD_KD * ((long)lastSpeed - (long)speed) * 1000 / dtMS;
+      lastSpeed = speed;
+
+      // conditional integration: not while pinned & pushing further
+      long output = pTerm + iTerm + dTerm;
+      if (! (output >= hi && error > 0) && ! (output <= lo && error < 0)) {
+        iTerm = constrain(iTerm + SPEED_HOLD_KI * error * dtMS / 1000, lo, hi);
+      }
+      output = constrain(pTerm + iTerm + dTerm, lo, hi);
+
+      #ifdef DEBUGGING_SPEEDHOLD
+        Serial.print(F("SpeedHold: sp="));
+        Serial.print(setpoint);
+        Serial.print(F(", v="));
+        Serial.print(speed);
+        Serial.print(F(", i="));
+        Serial.print(iTerm);
+        Serial.print(F(" -> "));
+        Serial.println(output);
+      #endif
+      return output / 1000000.0;
+    } // float update(speed, stickY, dt)
+}; // class SpeedHold
+
+#endif
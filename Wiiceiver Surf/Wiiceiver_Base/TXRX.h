@@ -29,32 +29,409 @@
 #ifndef TXRX_H
 #define TXRX_H
 
-// nrf24_reliable_datagram_client.pde
-#define CLIENT_ADDRESS 1
-#define SERVER_ADDRESS 2
+#include "RadioQueue.h"
+
+// NRF24 IRQ (active low) -> A1, pin change interrupt PCINT9.
+// #undef it for boards without the IRQ line; the radio is then polled
+// (still without waiting) from Chuck::update()
+#define RADIO_IRQ_PIN A1
+
+/*
+ * Radio link modes -- MUST match the Chuck:
+ *   default: RHReliableDatagram; every frame is ACKed, the Chuck retries
+ *   RADIO_STREAMING: fire-and-forget frames on the raw RH_NRF24 driver;
+ *     anything not newer (ControlFrame sequence #) than the last frame
+ *     is dropped.  For a stream where only the newest sample matters.
+ * Either way the payload is a ControlFrame (ControlFrame.h).
+ *
+ * When a frame carries CF_TELEMETRY the base answers, straight after
+ * the ACK (if any), with a TelemetryFrame; the Chuck listens for it
+ * briefly before powering its radio down.
+ */
+// #define RADIO_STREAMING
+
+/*
+ * Compute split -- MUST match the Chuck:
+ *   default: the Chuck sends the stick (ControlFrame); Throttle.h runs
+ *     here
+ *   TXMIT_THROTTLE: the Chuck runs Throttle.h and sends the finished
+ *     throttle (ThrottleFrame, a byte shorter); this end just applies
+ *     the failsafe and drives the ESC
+ */
+// #define TXMIT_THROTTLE
+
+// The Chuck only transmits when the stick or buttons change, and
+// otherwise every RADIO_HEARTBEAT ms -- MUST match the Chuck.  What
+// the base does when they stop coming: see Failsafe.h.
+#define RADIO_HEARTBEAT 40
+#define RADIO_SEQ_TIMEOUT (3 * RADIO_HEARTBEAT)  // ms; after a gap this long, accept any sequence #
+
+// Bench testing without a Chuck, lossy links & interference: see
+// host/link, which runs this sketch on a PC against a simulated one.
+typedef RH_NRF24 Radio;
+
+// addresses & channel come from the pairing table (Pairing.h):
+// the Chuck asks on PAIR_CHANNEL within PAIR_WINDOW ms of power-up
+// #define DEBUGGING_PAIRING
+#include "Pairing.h"
+#define PAIR_WINDOW 1000
+
+// Channel hopping (Hopper.h): every TelemetryFrame offers the next
+// channel; the Chuck echoes it in its ControlFrames, and both hop once
+// the base has the echo (reliable: when it's ACKed; streaming: the
+// Chuck hops after sending it).  If the Chuck goes quiet one side
+// missed that: look for it where it would be -- on the offered channel
+// (a streaming echo lost) or else the previous one (an ACK lost) --
+// alternating every HOP_FALLBACK ms, then at home.
+#define HOP_FALLBACK 70         // ms; a bit more than a heartbeat, so a
+                                // missed hop's found inside FAILSAFE_HOLD
+#define HOP_HOME 1000           // ms; the Chuck goes home after 1500
+// #define BENCHMARKING_HOP
+#include "Hopper.h"
+
+// where the time goes, stick to ESC (LinkTimer.h); in every TelemetryFrame
+// #define BENCHMARKING_LATENCY
+#include "LinkTimer.h"
 
 // Singleton instance of the radio driver
-RH_NRF24 driver;
+Radio driver;
 
 // Class to manage message delivery and receipt, using the driver declared above
-RHReliableDatagram manager(driver, SERVER_ADDRESS);
+RHReliableDatagram manager(driver);   // address set by setup_txmitter()
 
+Pairing pairing;
+Hopper hopper;
+volatile byte radioChannel;     // what the radio is tuned to
+
+
+  // frames received by the radio, waiting for Chuck::update()
+  RadioQueue radioQueue;
 
-  struct StatusMessage_t {
-    float chuckX, chuckY;    // [-1 .. 1]
-    bool buttons[8];         // chuck C, chuck Z, future TBD
-    float batteryLevel;      // [0 .. 1]
-  };
 
-  typedef union StatusPacket_t {
-    StatusMessage_t message;
-    byte bytes[sizeof(StatusMessage_t)];
+  // link statistics, kept by the receive path
+  struct RadioStats {
+    word received;      // frames accepted
+    word lost;          // gaps in the sequence
+    word stale;         // out of order or duplicate, dropped
+    word corrupt;       // bad length, CRC or version
+    word foreign;       // from a Chuck that isn't paired
+    byte maxGapMS;      // longest time between accepted frames (<= heartbeat)
+    word maxDrainUS;    // longest radio_drain()
   };
-  
-  void setup_txmitter() {
-    if (!manager.init()) {
-      Serial.println("init failed");
+  volatile RadioStats radioStats;
+  unsigned long lastFrameMS;
+
+
+  // what goes back to the Chuck; loop() fills it in (radio_setTelemetry),
+  // the receive path sends it
+  TelemetryFrame telemetry;
+  word lostTotal;       // like radioStats.lost, but never reset
+  bool corruptSince;    // since the last TelemetryFrame
+
+
+  // count an accepted frame
+  void radio_accepted(unsigned long now) {
+    byte gap = min(now - lastFrameMS, 255);
+    if (radioStats.received > 0 && gap > radioStats.maxGapMS) {
+      radioStats.maxGapMS = gap;
+    }
+    radioStats.received ++;
+    lastFrameMS = now;
+  } // radio_accepted(now)
+
+
+  // is seq newer than the last accepted frame?  Counts the gaps.
+  bool radio_fresh(byte seq, unsigned long now) {
+    static byte lastSeq = 0;
+    int8_t ahead = seq - lastSeq;
+    byte lost = 0;
+    if (now - lastFrameMS < RADIO_SEQ_TIMEOUT) {
+      if (ahead <= 0) {
+        radioStats.stale ++;
+        return false;
+      }
+      lost = ahead - 1;
+      radioStats.lost += lost;
+      lostTotal += lost;
+    }
+    hopper.heard(lost);
+    lastSeq = seq;
+    return true;
+  } // bool radio_fresh(seq, now)
+
+
+  // called from loop(): what to tell the Chuck next time it asks
+  void radio_setTelemetry(byte battery, float throttle, byte faults) {
+    noInterrupts();
+    telemetry.battery = battery;
+    telemetry.throttle = constrain(throttle * 100, -100, 100);
+    telemetry.faults = faults;
+    interrupts();
+  } // radio_setTelemetry(battery, throttle, faults)
+
+
+  void radio_tune(byte channel) {
+    driver.setChannel(channel);
+    radioChannel = channel;
+  } // radio_tune(channel)
+
+
+  // answer a CF_TELEMETRY request, offering the next hop; no ACK, no
+  // retries.  Stays on this channel: the Chuck's listening here.
+  void radio_sendTelemetry(byte to) {
+    TelemetryFrame frame = telemetry;
+    byte buf[TELEMETRY_FRAME_LEN];
+    frame.lost = lostTotal;
+    frame.channel = hopper.offer();
+    frame.latencyMS = linkTimer.latency.percentile(90);
+    frame.jitterMS = linkTimer.jitter.percentile(90);
+    frame.processMS = linkTimer.processP90;
+    if (corruptSince) {
+      frame.faults |= TF_CORRUPT;
+      corruptSince = false;
+    }
+    encodeTelemetryFrame(&frame, buf);
+    #ifdef RADIO_STREAMING
+      driver.setHeaderTo(to);
+      driver.send(buf, sizeof(buf));
+      driver.waitPacketSent();
+    #else
+      driver.setHeaderFlags(RH_FLAGS_NONE, RH_FLAGS_ACK);  // left over from the ACK
+      manager.sendto(buf, sizeof(buf), to);
+      manager.waitPacketSent();
+    #endif
+  } // radio_sendTelemetry(to)
+
+
+  // called from loop(): if the Chuck has gone quiet, go looking for it
+  void radio_hopFallback(void) {
+    noInterrupts();
+    unsigned long silentMS = millis() - lastFrameMS;
+    byte want = hopper.channel();
+    if (silentMS >= HOP_HOME) {
+      want = hopper.home();
+    } else if (silentMS >= HOP_FALLBACK && (silentMS / HOP_FALLBACK) % 2 == 1) {
+      want = hopper.offeredChannel() != hopper.channel() ? hopper.offeredChannel()
+                                                         : hopper.previousChannel();
+    }
+    if (want != radioChannel && pairing.hasChannel()) {
+      radio_tune(want);
+    }
+    interrupts();
+  } // radio_hopFallback()
+
+
+  // receive & decode one frame; false if there was nothing worth keeping
+  bool radio_recv(ControlFrame *control) {
+    byte buf[CONTROL_FRAME_LONG_LEN];  // the longest
+    byte len = sizeof(buf);
+    byte from;
+    #ifdef RADIO_STREAMING
+      bool received = driver.recv(buf, &len);
+      from = driver.headerFrom();
+    #else
+      // sends the ACK; only to a Chuck which knows our address, though
+      bool received = manager.recvfromAck(buf, &len, &from);
+    #endif
+    if (! received) {
+      return false;
+    }
+    if (! pairing.isPaired(from)) {
+      radioStats.foreign ++;
+      return false;
+    }
+    #ifdef TXMIT_THROTTLE
+      bool decoded = decodeThrottleFrame(buf, len, control);
+    #else
+      bool decoded = decodeControlFrame(buf, len, control);
+    #endif
+    if (! decoded) {
+      radioStats.corrupt ++;
+      corruptSince = true;
+      return false;
+    }
+    if (radioChannel != hopper.channel()) {
+      hopper.follow(radioChannel);  // found it, after a missed hop
+    }
+    unsigned long now = millis();
+    bool fresh = radio_fresh(control->seq, now);
+    if (fresh && control->hop) {
+      hopper.hop(control->hop);     // the Chuck has the offer
+    }
+    if (control->buttons & CF_TELEMETRY) {
+      radio_sendTelemetry(from);  // even for a duplicate: the Chuck is listening
+    }
+    if (radioChannel != hopper.channel()) {
+      radio_tune(hopper.channel()); // after the ACK & telemetry, on the old one
+    }
+    if (! fresh) {
+      return false;
+    }
+    if (control->extras) {
+      linkTimer.arrived(control->stamp, now);
+    }
+    return true;
+  } // bool radio_recv(control)
+
+
+  // copy the stats (consistently, the interrupt updates them);
+  // optionally start a new measurement period
+  void radio_getStats(RadioStats *stats, bool reset) {
+    noInterrupts();
+    stats->received = radioStats.received;
+    stats->lost = radioStats.lost;
+    stats->stale = radioStats.stale;
+    stats->corrupt = radioStats.corrupt;
+    stats->foreign = radioStats.foreign;
+    stats->maxGapMS = radioStats.maxGapMS;
+    stats->maxDrainUS = radioStats.maxDrainUS;
+    if (reset) {
+      radioStats.received = radioStats.lost = radioStats.stale = 0;
+      radioStats.corrupt = radioStats.foreign = 0;
+      radioStats.maxGapMS = 0;
+      radioStats.maxDrainUS = 0;
+    }
+    interrupts();
+  } // radio_getStats(stats, reset)
+
+
+  // move everything the radio is holding into radioQueue.
+  // Runs from the radio interrupt when RADIO_IRQ_PIN is defined (with
+  // interrupts back on; see below): nothing in loop() may touch
+  // manager / driver once the interrupt is on.
+  void radio_drain(void) {
+    unsigned long startUS = micros();
+    RadioFrame scratch;
+    while (driver.available()) {
+      RadioFrame *frame = radioQueue.reserve();
+      bool queued = frame != NULL;
+      if (! queued) {
+        frame = &scratch;  // full; still have to empty the radio FIFO
+      }
+      if (radio_recv(&frame->control)) {
+        frame->receivedMS = millis();
+        radio_accepted(frame->receivedMS);
+        if (queued) {
+          radioQueue.commit();
+        }
+      }
+    }
+    word drainUS = min(micros() - startUS, 65535);
+    if (drainUS > radioStats.maxDrainUS) {
+      radioStats.maxDrainUS = drainUS;
+    }
+  } // radio_drain()
+
+
+  /*
+   * The receive path has to answer inside the Chuck's ACK timeout
+   * (RADIO_ACK_TIMEOUT, 4ms), so it can't wait for loop().  Instead
+   * the interrupt masks itself (PCIE1) and turns interrupts back on
+   * before draining: millis(), micros() and the wheel sensor keep
+   * running, and only loop() waits.  Interrupts are off for a few
+   * instructions either side.
+   *
+   * Worst case, per frame: the FIFO read (~50us of SPI), the ACK and
+   * a telemetry reply (each ~130us TX settling + air time + the SPI
+   * around it, ~0.5ms) and a retune: ~1.5ms.  The NRF24 holds 3
+   * frames, so a drain is bounded at ~5ms, which loop() absorbs
+   * (it measures dt).  BENCHMARKING_RADIO prints the longest seen.
+   */
+  #ifdef RADIO_IRQ_PIN
+    ISR(PCINT1_vect) {
+      if (digitalRead(RADIO_IRQ_PIN) == LOW) {
+        PCICR &= ~(1 << PCIE1);   // no nesting; a new edge stays latched in PCIF1
+        sei();
+        radio_drain();
+        cli();
+        PCICR |= (1 << PCIE1);
+      }
+    } // ISR for the radio IRQ
+  #endif
+
+
+  // SoftwareServo times the ESC pulse by polling timer0 with interrupts
+  // on.  A drain (above) preempting it would stretch (or, past the
+  // timer0 wrap, wreck) the pulse.  So the radio waits out the refresh:
+  // the pin change stays latched in PCIF1 and the interrupt runs
+  // straight after.  Every refresh goes through here.
+  void servoRefresh(void) {
+    byte pcicr = PCICR;         // the radio interrupt's off until setup_txmitter()
+    PCICR = pcicr & ~(1 << PCIE1);
+    SoftwareServo::refresh();
+    PCICR = pcicr;
+  } // servoRefresh()
+
+
+  /*
+   * Listen on PAIR_CHANNEL for PAIR_WINDOW ms; pair with any Chuck that
+   * asks.  Polled -- runs before the radio interrupt is on.  The first
+   * Chuck to pair picks the board's channel.
+   */
+  void radio_pair(void) {
+    elapsedMillis window = 0;
+    driver.setChannel(PAIR_CHANNEL);
+    while (window < PAIR_WINDOW) {
+      byte buf[PAIR_FRAME_LEN];
+      byte len = sizeof(buf);
+      PairFrame frame;
+      if (! driver.recv(buf, &len) || len != PAIR_FRAME_LEN 
+          || ! decodePairFrame(buf, &frame) || frame.type != PAIR_REQUEST
+          || frame.address < PAIR_CHUCK_MIN || frame.address > PAIR_CHUCK_MAX) {
+        continue;
+      }
+      byte chuckAddress = frame.address;
+      if (! pairing.hasChannel()) {
+        pairing.chooseChannel(&driver);
+      }
+      pairing.add(chuckAddress);
+      Serial.print(F("Paired with Chuck #"));
+      Serial.println(chuckAddress);
+
+      frame.type = PAIR_ACCEPT;
+      frame.address = pairing.address;
+      frame.channel = pairing.channel;
+      encodePairFrame(&frame, buf);
+      driver.setHeaderTo(chuckAddress);
+      driver.send(buf, sizeof(buf));
+      driver.waitPacketSent();
     }
+  } // radio_pair()
+
+
+  void setup_txmitter() {
+    #ifdef RADIO_STREAMING
+      Serial.println(F("Radio: streaming"));
+      if (!driver.init()) {
+        Serial.println("init failed");
+      }
+    #else
+      Serial.println(F("Radio: reliable"));
+      if (!manager.init()) {
+        Serial.println("init failed");
+      }
+    #endif
+    pairing.readEEPROM();
+    manager.setThisAddress(pairing.address);  // and the driver's
+    radio_pair();
+    hopper.init(pairing.address, pairing.channel);
+    radio_tune(pairing.hasChannel() ? pairing.channel : PAIR_CHANNEL);
+    Serial.print(F("Board #"));
+    Serial.print(pairing.address);
+    Serial.print(F(", channel "));
+    Serial.print(pairing.channel);
+    Serial.print(F(", "));
+    Serial.print(pairing.count());
+    Serial.println(F(" Chuck(s) paired"));
+    #ifdef RADIO_IRQ_PIN
+      pinMode(RADIO_IRQ_PIN, INPUT_PULLUP);
+      cli();
+      PCMSK1 |= (1 << PCINT9);
+      PCIFR |= (1 << PCIF1);
+      PCICR |= (1 << PCIE1);
+      sei();
+      radio_drain();  // anything which arrived before the interrupt was on
+    #endif
   } // setup_txmitter()
 
 #endif
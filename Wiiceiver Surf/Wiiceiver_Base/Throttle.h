@@ -30,10 +30,14 @@
 #ifndef THROTTLE_H
 #define THROTTLE_H
 
-// not strictly necessary, but a nice reminder
-#include "Chuck.h"
+#include <avr/pgmspace.h>
+#include "ControlInput.h"
 #include "Smoover.h"
 #include "Cruiser.h"
+#include "Pipeline.h"
+#ifdef SPEED_HOLD
+  #include "SpeedHold.h"
+#endif
 
 
 /*
@@ -43,67 +47,205 @@
   THROTTLE and BRAKES each have their own settings
   and cruise control.
   
-  *_RISE : rate (%throttle per 20ms) of maximum increase
+  *_RISE : rate (throttle per second) of maximum increase
      higher RISE == harder acceleration
-  *_FALL : rate (% per 20ms) of reset to zero on idle
+  *_FALL : rate (per second) of reset to zero on idle
      lower FALL == snappier throttle response
   *_SMOOTH : exponential smoothing factor
      higher SMOOTH == more direct throttle response
      lower SMOOTH == softer throttle response
   *_MIN_BUMP : minimum change for any input
      probably don't need to change this
+  *_JERK : how fast (per second^2) the RISE rate itself ramps in
+     and out: an S-curve instead of a kick; 0 == off
      
-  #define THROTTLE_RISE     0.003  // roughly 15% increase per second
-  #define THROTTLE_FALL     0.005  // rought 25% decrease per second at idle
+  #define THROTTLE_RISE     0.15   // 15% increase per second
+  #define THROTTLE_FALL     0.25   // 25% decrease per second at idle
   #define THROTTLE_SMOOTH   0.050  // 5% exponential smoothing (1.0 disables it)
   #define THROTTLE_MIN_BUMP 0.003
   
-  #define BRAKES_RISE       0.004
-  #define BRAKES_FALL       0.005
+  #define BRAKES_RISE       0.20
+  #define BRAKES_FALL       0.25
   #define BRAKES_SMOOTH     0.050
   #define BRAKES_MIN_BUMP   0.003
 
-  *_CC_BUMP : max amount change for cruise control input
-     same calculation as throttle; usually softer
+  *_CC_RISE, *_CC_FALL : max change per second for cruise control
+     input, at full stick; same calculation as throttle; usually softer
   *_CC_AUTO : default "auto cruise" level (slowest cruise setting)
      for brakes, this is the "drag brake" when you hit Z
 
-  #define THROTTLE_CC_BUMP  0.002
+  #define THROTTLE_CC_RISE  0.10
   #define THROTTLE_CC_AUTO  0.000
   
-  #define BRAKES_CC_BUMP    0.003
+  #define BRAKES_CC_RISE    0.15
   #define BRAKES_CC_AUTO    0.050
+
+  *_TAU : time constant (seconds) the throttle eases down with
+     when coasting
 */
 
 
 // only accurate to 3 digits, sorry
-#define THROTTLE_RISE     0.002
-#define THROTTLE_FALL     0.005
+#define THROTTLE_RISE     0.10
+#define THROTTLE_FALL     0.25
 #define THROTTLE_SMOOTH   1.0 // 0.050
 #define THROTTLE_MIN_BUMP 0.003
 
-#define BRAKES_RISE       0.020
-#define BRAKES_FALL       0.020
+#define BRAKES_RISE       1.00
+#define BRAKES_FALL       1.00
 #define BRAKES_SMOOTH     1.0 // 0.100
 #define BRAKES_MIN_BUMP   0.003
 
-#define THROTTLE_CC_RISE  0.001
-#define THROTTLE_CC_FALL  0.003
+// jerk limits; 0.4 == full throttle rate in 1/4s
+#ifndef THROTTLE_JERK
+#define THROTTLE_JERK     0.0   // 0.4
+#endif
+#ifndef BRAKES_JERK
+#define BRAKES_JERK       0.0   // 8.0
+#endif
+
+#define THROTTLE_CC_RISE  0.05
+#define THROTTLE_CC_FALL  0.15
 #define THROTTLE_CC_AUTO  0.050
 
-#define BRAKES_CC_RISE    0.003
-#define BRAKES_CC_FALL    0.003
+#define BRAKES_CC_RISE    0.15
+#define BRAKES_CC_FALL    0.15
 #define BRAKES_CC_AUTO    0.050
 
+#define THROTTLE_COAST_TAU 0.070  // stick released: ~25% off per 20ms
+#define THROTTLE_HELI_TAU  0.190  // heli, coasting toward autoCruise: ~10% per 20ms
+
+/*
+ * Throttle modes: the button & stick decisions behind update(), as a
+ * table.  Each tick's input is classified into one event, the table
+ * gives the next mode from (mode, event), and the mode's handler runs.
+ * Every handler is straight-line, so a tick costs one lookup & one
+ * handler whichever way the chuck is held.
+ *
+ * TM_NONE is "no button held": it's never dispatched, the stick's
+ * event picks GAS, BRAKE or COAST from its row.  RETURNING is C while
+ * the Cruiser catches up to a cruise return; after a cruise tick the
+ * Cruiser's own state feeds back in as TE_RETURN / TE_CAUGHT_UP.
+ */
+#define TM_NONE       0
+#define TM_C          1   // cruise control
+#define TM_Z          2   // drag brake
+#define TM_BOTH       3   // C+Z: stick direct
+#define TM_GAS        4
+#define TM_BRAKE      5
+#define TM_COAST      6
+#define TM_RETURNING  7   // C, catching up to a cruise return
+#define TM_HELI       8   // Z in heli mode: dead-man switch
+#define TM_MODES      9
+
+#define TE_C          0   // C alone
+#define TE_Z          1   // Z alone
+#define TE_HELI       2   // Z alone, heli mode
+#define TE_BOTH       3   // C+Z, stick & throttle in the cruise band
+#define TE_HOLD       4   // C+Z otherwise: keep the button mode
+#define TE_UP         5   // no buttons, stick > THROTTLE_MIN
+#define TE_DOWN       6   // no buttons, stick < -THROTTLE_MIN
+#define TE_CENTER     7   // no buttons, stick idle
+#define TE_RETURN     8   // (after cruise) Cruiser is returning
+#define TE_CAUGHT_UP  9   // (after cruise) Cruiser isn't
+#define TE_EVENTS    10
+
+const byte throttleModes[TM_MODES][TE_EVENTS] PROGMEM = {
+  //          C      Z     HELI     BOTH     HOLD         UP      DOWN      CENTER    RETURN        CAUGHT_UP
+  /* NONE */ { TM_C, TM_Z, TM_HELI, TM_BOTH, TM_NONE,      TM_GAS, TM_BRAKE, TM_COAST, TM_NONE,      TM_NONE },
+  /* C    */ { TM_C, TM_Z, TM_HELI, TM_BOTH, TM_C,         TM_GAS, TM_BRAKE, TM_COAST, TM_RETURNING, TM_C },
+  /* Z    */ { TM_C, TM_Z, TM_HELI, TM_BOTH, TM_Z,         TM_GAS, TM_BRAKE, TM_COAST, TM_Z,         TM_Z },
+  /* BOTH */ { TM_C, TM_Z, TM_HELI, TM_BOTH, TM_BOTH,      TM_GAS, TM_BRAKE, TM_COAST, TM_BOTH,      TM_BOTH },
+  /* GAS  */ { TM_C, TM_Z, TM_HELI, TM_BOTH, TM_NONE,      TM_GAS, TM_BRAKE, TM_COAST, TM_GAS,       TM_GAS },
+  /* BRAKE*/ { TM_C, TM_Z, TM_HELI, TM_BOTH, TM_NONE,      TM_GAS, TM_BRAKE, TM_COAST, TM_BRAKE,     TM_BRAKE },
+  /* COAST*/ { TM_C, TM_Z, TM_HELI, TM_BOTH, TM_NONE,      TM_GAS, TM_BRAKE, TM_COAST, TM_COAST,     TM_COAST },
+  /* RET  */ { TM_RETURNING, TM_Z, TM_HELI, TM_BOTH, TM_RETURNING, TM_GAS, TM_BRAKE, TM_COAST, TM_RETURNING, TM_C },
+  /* HELI */ { TM_C, TM_Z, TM_HELI, TM_BOTH, TM_HELI,      TM_GAS, TM_BRAKE, TM_COAST, TM_HELI,      TM_HELI },
+};
+
+
+/*
+ * Curve: linear, from [in0 .. 1] to [out0 .. 1]; e.g. a stick just past
+ * THROTTLE_MIN is the lowest useful throttle
+ */
+class Curve {
+  private:
+    float in0, out0;
+
+  public:
+    Curve(float in0_ = 0, float out0_ = 0) {
+      set(in0_, out0_);
+    } // Curve(in0, out0)
+
+    void set(float in0_, float out0_) {
+      in0 = in0_;
+      out0 = out0_;
+    } // set(in0, out0)
+
+    float run(float x, float dt) {
+      return (x - in0) * (1.0 - out0) / (1.0 - in0) + out0;
+    } // float run(x, dt)
+
+    void zero(void) {
+    } // zero()
+}; // class Curve
+
+
+/*
+ * Clamp: [lo .. hi]
+ */
+class Clamp {
+  private:
+    float lo, hi;
+
+  public:
+    Clamp(float lo_ = -1, float hi_ = 1) {
+      set(lo_, hi_);
+    } // Clamp(lo, hi)
+
+    void set(float lo_, float hi_) {
+      lo = lo_;
+      hi = hi_;
+    } // set(lo, hi)
+
+    float run(float x, float dt) {
+      return x < lo ? lo : (x > hi ? hi : x);
+    } // float run(x, dt)
+
+    void zero(void) {
+    } // zero()
+}; // class Clamp
+
+
 /*
  * Manages the throttle input; presents a smoothed output, [ -1 .. 1 ]
+ *
+ * Runs on the base, or on the Chuck with TXMIT_THROTTLE; this file,
+ * Smoover.h and Cruiser.h are shared: keep the copies in Chuck/ and 
+ * Wiiceiver_Base/ identical.
+ *
+ * A stick past THROTTLE_MIN goes through a SurfPipeline: the curve up
+ * from the cruise (or drag brake) floor, the Smoover, the max throttle.
+ * Heli mode's active throttle is the same chain.  Which of them runs
+ * is up to the throttleModes table; one handler per mode.
+ *
+ * SPEED_HOLD (base only, needs a hall sensor): once the board's moving,
+ * C holds the wheel speed (SpeedHold.h) instead of a throttle.
  */
+typedef Pipeline<Curve, Smoover, Clamp> SurfPipeline;
 
 class Throttle {
   private:
     float throttle, maxThrottle;
-    Smoover *upper, *downer;
-    Cruiser *cruiser, *braker;
+    SurfPipeline gas, brakes;
+    Smoover &upper, &downer;          // the pipelines' Smoovers
+    Cruiser cruiser, braker;
+    byte mode;                        // TM_*
+    word entered[TM_MODES];           // transitions into each mode
+    #ifdef SPEED_HOLD
+      SpeedHold hold;                 // C, above SPEED_HOLD_MIN
+      word speed;                     // mm/s, from setSpeed()
+    #endif
 
 
     // http://forum.arduino.cc/index.php?topic=3922.0
@@ -111,33 +253,256 @@ class Throttle {
       return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
     } // float mapfloat(x, in_min, in_max, out_min, out_max)
 
+
+    // no buttons: which way is the stick?
+    byte stickEvent(const ControlInput& chuck) {
+      if (chuck.Y > THROTTLE_MIN) {
+        return TE_UP;
+      } else if (chuck.Y < -THROTTLE_MIN) {
+        return TE_DOWN;
+      }
+      return TE_CENTER;
+    } // byte stickEvent(chuck)
+
+
+    // a sort of button debouncing: C+Z only counts as BOTH when the
+    // stick & throttle are inside the cruise band, else it's a HOLD
+    byte classify(const ControlInput& chuck) {
+      if (chuck.C && !chuck.Z) {
+        return TE_C;
+      } else if (chuck.Z && !chuck.C) {
+        #ifdef ALLOW_HELI_MODE
+          if (settings.HELI_MODE) {
+            return TE_HELI;
+          }
+        #endif
+        return TE_Z;
+      } else if (!chuck.C && !chuck.Z) {
+        return stickEvent(chuck);
+      } else if (chuck.Y <= cruiser.getAutoCruise() && chuck.Y >= braker.getAutoCruise()
+                 && throttle <= cruiser.getAutoCruise() && throttle >= braker.getAutoCruise()) {
+        return TE_BOTH;
+      }
+      return TE_HOLD;
+    } // byte classify(chuck)
+
+
+    byte nextMode(byte event) {
+      return pgm_read_byte(&throttleModes[mode][event]);
+    } // byte nextMode(event)
+
+
+    void enter(byte next) {
+      if (next != mode) {
+        #ifdef SPEED_HOLD
+          if (next != TM_C && next != TM_RETURNING) {
+            hold.release();
+          }
+        #endif
+        entered[next] ++;
+        mode = next;
+      }
+    } // enter(next)
+
+
+    // TM_C, TM_RETURNING
+    void cruise(const ControlInput& chuck, float dt) {
+      #ifdef DEBUGGING_THROTTLE
+        Serial.print(F(" -C- "));
+      #endif
+      #ifdef SPEED_HOLD
+        if (hold.isEngaged() || hold.engage(throttle, speed)) {
+          throttle = hold.update(speed, chuck.Y, dt);
+          upper.rough(max(throttle, 0));
+          downer.rough(ABS(min(throttle, 0)));
+          return;
+        }
+      #endif
+      throttle = cruiser.update(throttle, chuck.X, chuck.Y, dt);
+      upper.rough(throttle);
+      downer.zero();
+    } // cruise(chuck, dt)
+
+
+    // after a cruise tick: is whichever cruise ran catching up?
+    bool cruiseReturning(void) {
+      #ifdef SPEED_HOLD
+        if (hold.isEngaged()) {
+          return hold.isReturning();
+        }
+      #endif
+      return cruiser.isReturning();
+    } // bool cruiseReturning()
+
+
+    // TM_Z
+    void dragBrake(const ControlInput& chuck, float dt) {
+      #ifdef DEBUGGING_THROTTLE
+        Serial.print(F(" -Z- "));
+      #endif
+      throttle = -braker.update(-throttle, chuck.X, -chuck.Y, dt);
+      downer.rough(ABS(throttle));
+      upper.zero();
+    } // dragBrake(chuck, dt)
+
+
+    // TM_HELI: Z == dead-man switch: run at min throttle (or Y, whichever)
+    // similar behavior to throttle stick at auto-cruise or higher
+    // stick is normalized tho
+    void heli(const ControlInput& chuck, float dt) {
+      #ifdef DEBUGGING_THROTTLE
+        Serial.print(F(" -Z- (heli) "));
+      #endif
+      float newY = mapfloat(chuck.Y, THROTTLE_MIN, 1.0, cruiser.getAutoCruise(), 1.0);
+      // if throttle > y, coasting; smooth
+      // if throttle < MIN be rough
+      if (chuck.Y < -THROTTLE_MIN) {
+        #ifdef DEBUGGING_THROTTLE
+          Serial.print(F(" [t<0; brakes] "));
+        #endif
+        throttle = 0;
+        upper.rough(throttle);
+      } else if (throttle < cruiser.getAutoCruise()) {
+        #ifdef DEBUGGING_THROTTLE
+          Serial.print(F(" [t<cruise; idle, rough] "));
+        #endif
+        throttle = cruiser.getAutoCruise();
+        upper.rough(throttle);
+      } else if (throttle > newY && newY <= cruiser.getAutoCruise()) {
+        #ifdef DEBUGGING_THROTTLE
+          Serial.print(F(" [coasting; smoove down] "));
+        #endif
+        float ease = 1.0 - exp(-dt / THROTTLE_HELI_TAU);
+        throttle = upper.smoove(throttle - (throttle - cruiser.getAutoCruise())*ease, dt);
+      } else {
+        #ifdef DEBUGGING_THROTTLE
+          Serial.print(F(" [active throttle; smoove] "));
+        #endif
+        throttle = gas.run(chuck.Y, dt);
+      }
+      downer.smoove(0, dt);
+      // Z == stick input, which resets cruise control
+      cruiser.zero();
+      braker.zero();
+    } // heli(chuck, dt)
+
+
+    // TM_BOTH
+    void both(const ControlInput& chuck, float dt) {
+      #ifdef DEBUGGING_THROTTLE
+        Serial.print(F(" -!!- "));
+      #endif
+      throttle = chuck.Y;
+      upper.rough(throttle);
+      downer.rough(throttle);
+      cruiser.zero();
+      braker.zero();
+    } // both(chuck, dt)
+
+
+    // TM_GAS
+    void gasOn(const ControlInput& chuck, float dt) {
+      #ifdef DEBUGGING_THROTTLE
+        Serial.print(F(" -^- "));
+      #endif
+      if (throttle < THROTTLE_MIN) { 
+        // transition brakes -> gas
+        throttle = max(THROTTLE_MIN, cruiser.getAutoCruise());
+        upper.rough(throttle);
+      } else {
+        throttle = gas.run(chuck.Y, dt);
+      }
+      downer.smoove(0, dt);
+      // stick input resets cruise control
+      cruiser.zero();
+      braker.zero();
+    } // gasOn(chuck, dt)
+
+
+    // TM_BRAKE
+    void brakesOn(const ControlInput& chuck, float dt) {
+      #ifdef DEBUGGING_THROTTLE
+        Serial.print(F(" -v- "));
+      #endif
+      if (throttle > -THROTTLE_MIN) {
+        // transition gas -> brakes
+        throttle = min(-THROTTLE_MIN, -braker.getAutoCruise());
+        downer.rough(ABS(throttle));
+      } else {
+        // the pipeline's positive only
+        throttle = -brakes.run(-chuck.Y, dt);
+      }
+      upper.smoove(0, dt);
+      // stick input resets cruise control
+      cruiser.zero();
+      braker.zero();
+    } // brakesOn(chuck, dt)
+
+
+    // TM_COAST (and TM_NONE, which never gets here)
+    void coast(const ControlInput& chuck, float dt) {
+      #ifdef DEBUGGING_THROTTLE
+        Serial.print(F(" -=- "));
+      #endif
+      cruiser.coast(dt);
+      braker.coast(dt);
+      // drop throttle gently
+      throttle = upper.smoove(throttle * exp(-dt / THROTTLE_COAST_TAU), dt);
+      // dump brakes immediately
+      downer.smoove(0, dt);
+    } // coast(chuck, dt)
+
     
   public:
     
-    // constructor
-    Throttle() {
-      upper =  new Smoover(THROTTLE_RISE, THROTTLE_FALL, 
-                           THROTTLE_SMOOTH, THROTTLE_MIN_BUMP);
-      downer = new Smoover(BRAKES_RISE, BRAKES_FALL,
-                           BRAKES_SMOOTH, BRAKES_MIN_BUMP);
-
-      cruiser = new Cruiser(THROTTLE_CC_RISE, THROTTLE_CC_FALL,   
-                            THROTTLE_CC_AUTO, EEPROM_AUTOCRUISE_ADDY);
-      braker =  new Cruiser(BRAKES_CC_RISE, BRAKES_CC_FALL,
-                            BRAKES_CC_AUTO, EEPROM_DRAGBRAKE_ADDY);
+    // constructor; everything's embedded, nothing on the heap
+    Throttle() 
+      : gas(Curve(THROTTLE_MIN, THROTTLE_CC_AUTO),
+            Smoover(THROTTLE_RISE, THROTTLE_FALL, 
+                    THROTTLE_SMOOTH, THROTTLE_MIN_BUMP, THROTTLE_JERK),
+            Clamp(0, 1)),
+        brakes(Curve(THROTTLE_MIN, BRAKES_CC_AUTO),
+               Smoover(BRAKES_RISE, BRAKES_FALL,
+                       BRAKES_SMOOTH, BRAKES_MIN_BUMP, BRAKES_JERK),
+               Clamp(0, 1)),
+        upper(gas.get<Smoover>()),
+        downer(brakes.get<Smoover>()),
+        cruiser(THROTTLE_CC_RISE, THROTTLE_CC_FALL,   
+                THROTTLE_CC_AUTO, EEPROM_AUTOCRUISE_ADDY),
+        braker(BRAKES_CC_RISE, BRAKES_CC_FALL,
+               BRAKES_CC_AUTO, EEPROM_DRAGBRAKE_ADDY) {
       throttle = 0;
+      mode = TM_NONE;
+      memset(entered, 0, sizeof(entered));
+      #ifdef SPEED_HOLD
+        speed = 0;
+      #endif
     } // Throttle()
     
 
     void init() {
-      upper->init();
-      downer->init();
-      cruiser->init();
-      braker->init();
+      upper.init();
+      downer.init();
+      cruiser.init();
+      braker.init();
       maxThrottle = 0.01 * readSetting(EEPROM_MAXTHROTTLE_ADDY, 100);
+      gas.get<Curve>().set(THROTTLE_MIN, cruiser.getAutoCruise());
+      gas.get<Clamp>().set(0, maxThrottle);
+      brakes.get<Curve>().set(THROTTLE_MIN, braker.getAutoCruise());
+      #ifdef SPEED_HOLD
+        hold.setLimit(maxThrottle);
+      #endif
       zero();
     } // init()
 
+
+    // an accel profile's multiplier (utils.h) for the gas & brakes,
+    // without the EEPROM: for benchmarks
+    void setProfile(float multiplier) {
+      upper.init(multiplier);
+      downer.init(multiplier);
+    } // setProfile(multiplier)
+
     
     /*
      * returns a smoothed (rate-limited) float [-1 .. 1]
@@ -157,13 +522,24 @@ class Throttle {
      *   if HELI_MODE: treat Z like dead-man switch; Z on == auto-cruise (slowest throttle)
      *     to fake neutral.  Z off == lowest stick, which is either neutral or brake
      *     on the ESC
+     *
+     *   dt is the time (seconds) since the last update; all the rates
+     *   are per second
      */
-    float update(Chuck chuck) {
-      #define CHUCK_C 1
-      #define CHUCK_Z 2
-      #define CHUCK_BOTH 3
-      #define CHUCK_NONE 0
-      static byte lastChuckButton = CHUCK_NONE;
+    float update(const ControlInput& chuck, float dt) {
+      typedef void (Throttle::*Handler)(const ControlInput&, float);
+      // indexed by TM_*; in flash, like the table
+      static const Handler handlers[TM_MODES] PROGMEM = {
+        &Throttle::coast,       // TM_NONE
+        &Throttle::cruise,      // TM_C
+        &Throttle::dragBrake,   // TM_Z
+        &Throttle::both,        // TM_BOTH
+        &Throttle::gasOn,       // TM_GAS
+        &Throttle::brakesOn,    // TM_BRAKE
+        &Throttle::coast,       // TM_COAST
+        &Throttle::cruise,      // TM_RETURNING
+        &Throttle::heli,        // TM_HELI
+      };
       
       #ifdef DEBUGGING_THROTTLE
         Serial.print(F("Throttle: "));
@@ -179,146 +555,25 @@ class Throttle {
         Serial.print(F("; "));
       #endif
 
-      // a sort of button debouncing
-      if (chuck.C && !chuck.Z) {
-        lastChuckButton = CHUCK_C;
-      } else if (chuck.Z && !chuck.C) {
-        lastChuckButton = CHUCK_Z;
-      } else if (!chuck.C && !chuck.Z) {
-        lastChuckButton = CHUCK_NONE;
-      } else if (chuck.Y <= cruiser->getAutoCruise() && chuck.Y >= braker->getAutoCruise()
-                 && throttle <= cruiser->getAutoCruise() && throttle >= braker->getAutoCruise() 
-                 && chuck.C && chuck.Z) {
-        lastChuckButton = CHUCK_BOTH;
+      byte next = nextMode(classify(chuck));
+      if (next == TM_NONE) {
+        // no button mode (any more): the stick decides
+        next = pgm_read_byte(&throttleModes[TM_NONE][stickEvent(chuck)]);
       }
+      enter(next);
       
       #ifdef DEBUGGING_THROTTLE_BUTTONS
-        Serial.print(F(" button:"));
-        if (lastChuckButton) {
-          Serial.print(lastChuckButton == CHUCK_C ? F("C; ") : F("Z; "));
-        } else {
-          Serial.print(F("-; "));
-        }
+        Serial.print(F(" mode:"));
+        Serial.print(mode);
+        Serial.print(F("; "));
       #endif
-      
-      if (lastChuckButton == CHUCK_C) {
-        #ifdef DEBUGGING_THROTTLE
-          Serial.print(F(" -C- "));
-        #endif
-        throttle = cruiser->update(throttle, chuck.X, chuck.Y);
-        upper->rough(throttle);
-        downer->zero();
-      } else if (lastChuckButton == CHUCK_Z) {
-        #ifdef DEBUGGING_THROTTLE
-          Serial.print(F(" -Z- "));
-        #endif
-        #ifdef ALLOW_HELI_MODE
-          if (settings.HELI_MODE) {
-            #ifdef DEBUGGING_THROTTLE
-              Serial.print(F(" (heli) "));
-            #endif
-            // Z == dead-man switch: run at min throttle (or Y, whichever)
-            // similar behavior to throttle stick at auto-cruise or higher
-            // stick is normalized tho
-  
-            float newY = mapfloat(chuck.Y, THROTTLE_MIN, 1.0, cruiser->getAutoCruise(), 1.0);
-            // if throttle > y, coasting; smooth
-            // if throttle < MIN be rough
-            if (chuck.Y < -THROTTLE_MIN) {
-               #ifdef DEBUGGING_THROTTLE
-                Serial.print(F(" [t<0; brakes] "));
-              #endif
-              throttle = 0;
-              upper->rough(throttle);
-            } else if (throttle < cruiser->getAutoCruise()) {
-              #ifdef DEBUGGING_THROTTLE
-                Serial.print(F(" [t<cruise; idle, rough] "));
-              #endif
-              throttle = cruiser->getAutoCruise();
-              upper->rough(throttle);
-            } else if (throttle > newY && newY <= cruiser->getAutoCruise()) {
-              Serial.print(F(" [coasting; smoove down] "));
-              throttle = upper->smoove(throttle - (throttle - cruiser->getAutoCruise())*0.1);
-            } else {
-              Serial.print(F(" [active throttle; smoove] "));
-              throttle = upper->smoove(newY);
-            }
-            downer->smoove(0);
-            // Z == stick input, which resets cruise control
-            cruiser->zero();
-            braker->zero();
-          } else {
-         #else
-            // not heli; Z == drag brake
-            throttle = -braker->update(-throttle, chuck.X, -chuck.Y);
-            downer->rough(ABS(throttle));
-            upper->zero();
-        #endif
-        #ifdef ALLOW_HELI_MODE
-          }
-        #endif
-      } else if (lastChuckButton == CHUCK_BOTH) {
-        #ifdef DEBUGGING_THROTTLE
-          Serial.print(F(" -!!- "));
-        #endif
-        throttle = chuck.Y;
-        upper->rough(throttle);
-        downer->rough(throttle);
-        cruiser->zero();
-        braker->zero();
-      } else if (chuck.Y > THROTTLE_MIN) {  
-        // gas
-        #ifdef DEBUGGING_THROTTLE
-          Serial.print(F(" -^- "));
-        #endif
-        if (throttle < THROTTLE_MIN) { 
-          // transition brakes -> gas
-          throttle = max(THROTTLE_MIN, cruiser->getAutoCruise());
-          upper->rough(throttle);
-        } else {
-          float newY = mapfloat(chuck.Y, THROTTLE_MIN, 1.0, cruiser->getAutoCruise(), 1.0);
-          throttle = upper->smoove(newY);
-        }
-        downer->smoove(0);
-        // stick input resets cruise control
-        cruiser->zero();
-        braker->zero();
-      } else if (chuck.Y < -THROTTLE_MIN) {
-        // brakes
-        #ifdef DEBUGGING_THROTTLE
-        Serial.print(F(" -v- "));
-        #endif
-        if (throttle > -THROTTLE_MIN) {
-          // transition gas -> brakes
-          throttle = min(-THROTTLE_MIN, -braker->getAutoCruise());
-          downer->rough(ABS(throttle));
-        } else {
-          float newY = mapfloat(chuck.Y, -THROTTLE_MIN, -1.0, -braker->getAutoCruise(), -1.0);
-          #ifdef DEBUGGING_THROTTLE
-            Serial.print(F(" newY:"));
-            Serial.print(newY);
-            Serial.print(F(" "));
-          #endif
-          // throttle = -downer->smoove(ABS(chuck.Y));
-          throttle = -downer->smoove(ABS(newY));
-        }
-        upper->smoove(0);
-        // stick input resets cruise control
-        cruiser->zero();
-        braker->zero();
-      } else {
-        // coasting
-        #ifdef DEBUGGING_THROTTLE
-          Serial.print(F(" -=- "));
-        #endif
 
-        cruiser->coast();
-        braker->coast();
-        // throttle = upper->smoove(0);
-        // drop throttle gently
-        throttle = upper->smoove(throttle*0.75);
-        // dump brakes immediately
-        downer->smoove(0);
+      Handler handler;
+      memcpy_P(&handler, &handlers[mode], sizeof(handler));
+      (this->*handler)(chuck, dt);
+
+      if (mode == TM_C || mode == TM_RETURNING) {
+        enter(nextMode(cruiseReturning() ? TE_RETURN : TE_CAUGHT_UP));
       }
 
       #ifdef DEBUGGING_THROTTLE
@@ -329,20 +584,84 @@ class Throttle {
       throttle = min(throttle, maxThrottle);
 
       return throttle;
-    } // float update(void)
+    } // float update(chuck, dt)
     
     
+    // the link is failing: ease toward 0 by step, taking the smoothers
+    // along so the throttle picks up from here when it's back
+    float decay(float step) {
+      #ifdef SPEED_HOLD
+        hold.release();             // re-engages from here, if C still is
+      #endif
+      if (throttle > 0) {
+        throttle = max(throttle - step, 0);
+      } else {
+        throttle = min(throttle + step, 0);
+      }
+      upper.rough(max(throttle, 0));
+      downer.rough(ABS(min(throttle, 0)));
+      return throttle;
+    } // float decay(step)
+
+
+    // take a throttle finished elsewhere (the Chuck, TXMIT_THROTTLE);
+    // decay() picks up from here
+    float set(float value) {
+      throttle = min(value, maxThrottle);
+      upper.rough(max(throttle, 0));
+      downer.rough(ABS(min(throttle, 0)));
+      return throttle;
+    } // float set(value)
+
+
     float getThrottle(void) {
       return throttle;
     } // float getThrottle()
+
+
+    float getMaxThrottle(void) {
+      return maxThrottle;
+    } // float getMaxThrottle()
+
+
+    #ifdef SPEED_HOLD
+      // the wheel speed (mm/s) for the next update()
+      void setSpeed(word mmps) {
+        speed = mmps;
+      } // setSpeed(mmps)
+    #endif
+
+
+    byte getMode(void) {
+      return mode;
+    } // byte getMode()
+
+
+    // transitions into mode (TM_*) since startup; wraps
+    word getEntries(byte m) {
+      return entered[m];
+    } // word getEntries(m)
+
+
+    // telemetry: the entry counts, TM_* order
+    void printModes(void) {
+      Serial.print(F("throttle modes: "));
+      for (byte m = 0; m < TM_MODES; m++) {
+        Serial.print(entered[m]);
+        Serial.print(m < TM_MODES - 1 ? F("/") : F("\n"));
+      }
+    } // printModes()
     
     
     void zero(void) {
       throttle = 0;
-      upper->zero();
-      downer->zero();
-      cruiser->zero();
-      braker->zero();
+      upper.zero();
+      downer.zero();
+      cruiser.zero();
+      braker.zero();
+      #ifdef SPEED_HOLD
+        hold.release();
+      #endif
     } // void zero(void)
 
     
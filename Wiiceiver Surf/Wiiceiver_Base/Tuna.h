@@ -234,19 +234,18 @@ void do_ui() {
 
 
 /*
- * enter the tuna if C+Z / no throttle, for 250 attempts (5s)
+ * enter the tuna if C+Z / no throttle, held for 5s (at any loop rate)
  */
 void tuna() {
-  static int attempts = 0;
-  static elapsedMillis lastAttempt = 0;
+  static elapsedMillis heldMS = 0;
   
   if (! (chuck.C && chuck.Z) 
       || ABS(throttle.getThrottle()) > THROTTLE_MIN) {
-    attempts = 0;
+    heldMS = 0;
     return;
   }
   
-  if (++attempts < 250) {
+  if (heldMS < 5000) {
     // not there yet
     return;
   }
@@ -262,7 +261,7 @@ void tuna() {
   green.start(1);
   throttle.init();
   watchdog_setup(WDTO_250MS);
-  attempts = 0;
+  heldMS = 0;
 } // tuna()
 
 
@@ -0,0 +1,123 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+#ifndef WHEELSPEED_H
+#define WHEELSPEED_H
+
+// hall sensor (wheel magnets, or one of the motor's halls), open
+// collector -> D7, pin change interrupt PCINT23.  D2/D3 are the LEDs
+// and PCINT1 (port C) is the radio's, so port D's vector it is.
+#define HALL_PIN 7
+#ifndef WHEEL_MM_PER_PULSE
+  #define WHEEL_MM_PER_PULSE 40       // travel per rising edge: circumference / magnets
+#endif
+#define WHEEL_STOPPED_MS 500          // no edge for this long == stopped
+
+
+/*
+ * WheelSpeed: board speed from the period between hall edges.
+ *
+ * pulse() runs in the interrupt (or a simulator, with its own clock):
+ * it only stamps the edge and counts it.  mmps() averages every edge
+ * since the last call, so a fast wheel's many edges are smoothed and
+ * a slow wheel still answers from the last whole period; once the
+ * wheel is overdue the time since the last edge stands in for the
+ * period, so the speed falls off rather than sticking.
+ *
+ * ex:
+ *   wheel.init();                   // setup(); turns on the interrupt
+ *   word speed = wheel.mmps(micros());
+ */
+class WheelSpeed {
+  private:
+    volatile unsigned long lastUS;    // the newest edge
+    volatile word edges;              // since windowUS
+    unsigned long windowUS;           // the last edge counted by mmps()
+    unsigned long periodUS;           // between edges; 0 == stopped
+
+
+  public:
+
+    WheelSpeed() {
+      lastUS = windowUS = periodUS = 0;
+      edges = 0;
+    } // WheelSpeed()
+
+
+    void init(void) {
+      pinMode(HALL_PIN, INPUT_PULLUP);
+      cli();
+      PCMSK2 |= (1 << PCINT23);
+      PCIFR |= (1 << PCIF2);
+      PCICR |= (1 << PCIE2);
+      sei();
+    } // init()
+
+
+    // one rising edge at us (micros() in the interrupt)
+    void pulse(unsigned long us) {
+      lastUS = us;
+      edges ++;
+    } // pulse(us)
+
+
+    // mm/s as of nowUS; 0 when stopped
+    word mmps(unsigned long nowUS) {
+      noInterrupts();
+      unsigned long last = lastUS;
+      word n = edges;
+      edges = 0;
+      interrupts();
+
+      if (n > 0) {
+        unsigned long span = last - windowUS;
+        // first edge after a stop: no period yet
+        periodUS = span < WHEEL_STOPPED_MS * 1000UL ? span / n : 0;
+        windowUS = last;
+      }
+      unsigned long sinceUS = nowUS - windowUS;
+      if (periodUS == 0 || sinceUS >= WHEEL_STOPPED_MS * 1000UL) {
+        periodUS = 0;
+        return 0;
+      }
+      unsigned long us = max(periodUS, sinceUS);
+      return min(WHEEL_MM_PER_PULSE * 1000000UL / us, 65535UL);
+    } // word mmps(nowUS)
+}; // class WheelSpeed
+
+
+WheelSpeed wheel;
+
+ISR(PCINT2_vect) {
+  if (PIND & (1 << PIND7)) {
+    wheel.pulse(micros());
+  }
+} // ISR for the hall sensor
+
+#endif
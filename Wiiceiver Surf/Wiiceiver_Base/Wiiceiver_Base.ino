@@ -32,12 +32,12 @@
 // this is stupid; when did abs() stop working with floats?
 #define ABS(X) (X > 0 ? X : -X)
 
-// for SoftwareServo convenience
+// for SoftwareServo convenience; servoRefresh() is in TXRX.h
 #include "elapsedMillis.h"
 #define DELAY(N) \
   { elapsedMillis eM = 0; \
   while (eM < N) { \
-    SoftwareServo::refresh(); \
+    servoRefresh(); \
     delay(1); \
   } }
 
@@ -51,8 +51,6 @@
 #include <RH_NRF24.h>
 #include <SPI.h>
 
-#include "TXRX.h"
-
 
 #define WSB_VERSION "0.1"
 
@@ -69,6 +67,12 @@
 #define EEPROM_MAXTHROTTLE_ADDY 5
 #define EEPROM_ACCELPROFILE_ADDY 6
 #define EEPROM_HELI_MODE_ADDY 7
+#define EEPROM_PAIR_ADDRESS_ADDY 8
+#define EEPROM_PAIR_CHANNEL_ADDY 9
+#define EEPROM_PAIR_CHUCKS_ADDY 10         // .. 22: a bit per Chuck
+
+// #define BENCHMARKING_FRAME
+#include "TXRX.h"
 
 #define DEBUGGING
 
@@ -81,9 +85,19 @@
 
 #include "Blinker.h"
 
+// #define FAILSAFE_HOLD 110
+// #define FAILSAFE_TRIP 190
+// #define FAILSAFE_RAMP 1.0
+#include "Failsafe.h"
+
 // #define DEBUGGING_CHUCK
 // #define DEBUGGING_CHUCK_ACTIVITY
-#define WII_ACTIVITY_COUNTER 100  // once per 20ms; 50 per second
+// #define BENCHMARKING_RADIO
+// a nunchuck wired to the base's I2C as well as the radio one; see
+// Chuck.h for which drives the board
+// #define WIRED_CHUCK
+// #define INPUT_PRIMARY INPUT_WIRED
+// #define DEBUGGING_FAILOVER
 #include "Chuck.h"
 
 #define DEBUGGING_ESC
@@ -94,12 +108,52 @@
 
 #define THROTTLE_MIN 0.05                      // the lowest throttle to send the ESC
 
+// control loop period (ms); the throttle's rates are per second, so from
+// 2 (500Hz) to 20 (50Hz) it rides the same (host/rates: within a tick).
+// Nothing else here counts ticks: the radio's on its interrupt,
+// the failsafe and failover are in ms and the ESC refresh keeps its 20ms.
+#define LOOP_MS 20
+#define LOOP_MAX_DT 0.1                        // s; a longer gap (a stall) counts as this
+
+// board battery, through a divider, for the Chuck's telemetry display;
+// without it the Chuck is told TF_NO_BATTERY
+// #define BOARD_BATTERY_PIN A3
+#define BOARD_BATTERY_EMPTY 614                // ADC counts; depends on the divider
+#define BOARD_BATTERY_FULL 860
+
 // #define DEBUGGING_CRUISER
 #include "Cruiser.h"
 
+// closed-loop cruise: once moving, C holds the wheel speed from a hall
+// sensor (WheelSpeed.h) instead of a throttle.  Needs the throttle
+// computed here, not TXMIT_THROTTLE
+// #define SPEED_HOLD
+// #define WHEEL_MM_PER_PULSE 40
+// #define DEBUGGING_SPEEDHOLD
+#ifdef SPEED_HOLD
+  #ifdef TXMIT_THROTTLE
+    #error "SPEED_HOLD runs on the base; undefine TXMIT_THROTTLE"
+  #endif
+  #include "WheelSpeed.h"
+#endif
+
 #define DEBUGGING_THROTTLE
+// S-curve launches (see Smoover.h); 0 or unset == off
+// #define THROTTLE_JERK 0.4
+// #define BRAKES_JERK 8.0
 #include "Throttle.h"
 
+// per-tick cost of chuck.update() through ESC.setLevel(), for comparing
+// the compute splits (TXMIT_THROTTLE); turn off DEBUGGING_THROTTLE first
+// #define BENCHMARKING_PIPELINE
+// heap size and the stack's worst-case headroom, every ~10s
+// #define BENCHMARKING_RAM
+#ifdef BENCHMARKING_RAM
+  #include "RamReport.h"
+#endif
+// replays and simulations of the throttle (loop rates, launch jerk,
+// accel profiles, the speed hold) run on a PC: see host/
+
 
 // global objects
 
@@ -164,6 +218,18 @@ void updateLEDs(float throttlePos) {
 } // updateLEDs(float throttle)
 
 
+// tell the radio what to report to the Chuck
+void updateTelemetry(float throttleValue, byte faults) {
+  #ifdef BOARD_BATTERY_PIN
+    int battery = map(analogRead(BOARD_BATTERY_PIN), 
+                      BOARD_BATTERY_EMPTY, BOARD_BATTERY_FULL, 0, 15);
+    radio_setTelemetry(constrain(battery, 0, 15), throttleValue, faults);
+  #else
+    radio_setTelemetry(0, throttleValue, faults | TF_NO_BATTERY);
+  #endif
+} // updateTelemetry(throttleValue, faults)
+
+
 // the nunchuck appears to be static: we lost connection!
 // go "dead" for up to 5s, but keep checking the chuck to see if
 // it comes back
@@ -246,7 +312,7 @@ bool startChuck() {
     #endif
     wdt_reset();
     chuck.setup();
-    SoftwareServo::refresh();
+    servoRefresh();
     chuck.readEEPROM();
     tries ++;
     if (waitForActivity()) {
@@ -257,6 +323,34 @@ bool startChuck() {
 } // startChuck()
 
 
+#ifdef BENCHMARKING_PIPELINE
+// tally one tick; every 250, print it with the link timing
+void benchmarkPipeline(unsigned long tickUS) {
+  static unsigned long pipelineUS = 0, maxPipelineUS = 0;
+  static word ticks = 0;
+  pipelineUS += tickUS;
+  maxPipelineUS = max(maxPipelineUS, tickUS);
+  if (++ticks == 250) {
+    #ifdef TXMIT_THROTTLE
+      Serial.print(F("pipeline (split: chuck): avg "));
+    #else
+      Serial.print(F("pipeline (split: base): avg "));
+    #endif
+    Serial.print(pipelineUS / ticks);
+    Serial.print(F("us, max "));
+    Serial.print(maxPipelineUS);
+    Serial.println(F("us per tick"));
+    linkTimer.print();
+    #ifndef TXMIT_THROTTLE
+      throttle.printModes();
+    #endif
+    pipelineUS = maxPipelineUS = 0;
+    ticks = 0;
+  }
+} // benchmarkPipeline(tickUS)
+#endif
+
+
 // pretty much what it sounds like
 void handleInactivity() {
   watchdog_setup(WDTO_8S);
@@ -268,6 +362,8 @@ void handleInactivity() {
   // smoother.zero();  // kills throttle history
   throttle.zero();
   ESC.setLevel(0);
+  updateTelemetry(0, TF_FAILSAFE);
+  gapLog.print();
   
   // this loop: try to restart 5 times in 5s; repeat until active
   do {    
@@ -301,6 +397,9 @@ void handleInactivity() {
 
 
 void setup() {
+  #ifdef BENCHMARKING_RAM
+    ramPaint();
+  #endif
   wdt_disable();
   Serial.begin(115200);
 
@@ -319,6 +418,9 @@ void setup() {
 
   setup_pins();
   ESC.init(pinLocation(ESC_PPM_ID), pinLocation(ESC2_PPM_ID));
+  #ifdef SPEED_HOLD
+    wheel.init();
+  #endif
   
   splashScreen();
   showTunaSettings();
@@ -338,6 +440,9 @@ void setup() {
   #ifdef DEBUGGING
     Serial.println(F("Nunchuck is active!"));
   #endif
+  #ifdef BENCHMARKING_FRAME
+    benchmarkControlFrame();
+  #endif
 
   green.start(10);
   red.start(10);
@@ -350,18 +455,96 @@ void setup() {
 
 
 
+// seconds since the last call, for the throttle's per-second rates
+float tickSeconds(void) {
+  static unsigned long lastUS = micros();
+  unsigned long nowUS = micros();
+  float dt = (nowUS - lastUS) / 1000000.0;
+  lastUS = nowUS;
+  return min(dt, LOOP_MAX_DT);
+} // float tickSeconds()
+
+
 void loop() {
   static float lastThrottleValue = 0;
+  static byte lastSeq = 0;
   unsigned long startMS = millis();
   elapsedMillis timeElapsed = 0;
   wdt_reset();
-  SoftwareServo::refresh();
+  servoRefresh();
   green.run();
   red.run();
+  #ifdef BENCHMARKING_RADIO
+    static unsigned long updateUS = 0, maxUpdateUS = 0;
+    static word benchTicks = 0;
+    unsigned long startUS = micros();
+  #endif
+  #ifdef BENCHMARKING_PIPELINE
+    unsigned long pipelineUS = micros();
+  #endif
   chuck.update();
+  float dt = tickSeconds();
+  #ifdef BENCHMARKING_RADIO
+    unsigned long tickUS = micros() - startUS;
+    updateUS += tickUS;
+    maxUpdateUS = max(maxUpdateUS, tickUS);
+    if (++benchTicks == 250) {
+      // the old busy-wait took up to 10000us of every 20ms tick
+      Serial.print(F("chuck.update(): avg "));
+      Serial.print(updateUS / benchTicks);
+      Serial.print(F("us, max "));
+      Serial.print(maxUpdateUS);
+      Serial.print(F("us; queue overruns "));
+      Serial.println(radioQueue.getOverruns());
+      RadioStats stats;
+      radio_getStats(&stats, true);
+      Serial.print(F("radio: received "));
+      Serial.print(stats.received);
+      Serial.print(F(", lost "));
+      Serial.print(stats.lost);
+      Serial.print(F(", stale "));
+      Serial.print(stats.stale);
+      Serial.print(F(", corrupt "));
+      Serial.print(stats.corrupt);
+      Serial.print(F(", foreign "));
+      Serial.print(stats.foreign);
+      Serial.print(F(", max gap "));
+      Serial.print(stats.maxGapMS);
+      Serial.print(F("ms, longest drain "));
+      Serial.print(stats.maxDrainUS);
+      Serial.println(F("us"));
+      updateUS = maxUpdateUS = 0;
+      benchTicks = 0;
+    }
+  #endif
+  #ifdef BENCHMARKING_HOP
+    static word hopTicks = 0;
+    if (++hopTicks == 500) {
+      // every ~10s; counters may tear, the radio interrupt stays on
+      hopper.printStats();
+      hopTicks = 0;
+    }
+  #endif
+  #ifdef BENCHMARKING_RAM
+    static word ramTicks = 0;
+    if (++ramTicks == 500) {
+      ramReport();
+      ramTicks = 0;
+    }
+  #endif
+  #ifdef BENCHMARKING_LATENCY
+    static word latencyTicks = 0;
+    if (++latencyTicks == 500) {
+      linkTimer.print();
+      latencyTicks = 0;
+    }
+  #endif
 
-  // check for the tuning UI
-  tuna();
+  // check for the tuning UI; with TXMIT_THROTTLE the settings it
+  // changes aren't used here
+  #ifndef TXMIT_THROTTLE
+    tuna();
+  #endif
   
   // for forcing a watchdog timeout (testing)
   #undef SUICIDAL_Z
@@ -378,8 +561,30 @@ void loop() {
     #endif
     handleInactivity();
   } else {
-    float throttleValue = throttle.update(chuck);
+    float throttleValue;
+    if (failsafeStage(chuck.age()) == FAILSAFE_DECAYING) {
+      // frames are late: ease off until they're back (or we trip)
+      throttleValue = throttle.decay(FAILSAFE_RAMP * dt);
+    } else {
+      #ifdef TXMIT_THROTTLE
+        throttleValue = throttle.set(chuck.Y);  // finished on the Chuck
+      #else
+        #ifdef SPEED_HOLD
+          throttle.setSpeed(wheel.mmps(micros()));
+        #endif
+        throttleValue = throttle.update(ControlInput(chuck), dt);
+      #endif
+    }
     ESC.setLevel(throttleValue);
+    #ifdef BENCHMARKING_PIPELINE
+      benchmarkPipeline(micros() - pipelineUS);
+    #endif
+    if (chuck.control.seq != lastSeq) {
+      // a new frame made it to the ESC
+      linkTimer.processed(chuck.age());
+      lastSeq = chuck.control.seq;
+    }
+    updateTelemetry(throttleValue, 0);
     if (throttleValue != lastThrottleValue) {
       updateLEDs(throttle.getThrottle());
       #ifdef DEBUGGING
@@ -398,13 +603,24 @@ void loop() {
     } // if (throttleValue != lastThrottleValue)
     
     // int delayMS = constrain(startMS + 21 - millis(), 5, 20);
-    if (timeElapsed < 20) {
-      byte delayMS = 20 - timeElapsed;
+    if (timeElapsed < LOOP_MS) {
+      byte delayMS = LOOP_MS - timeElapsed;
       #ifdef DEBUGGING_INTERVALS
         Serial.print(F("sleeping ")); 
         Serial.println(delayMS);
       #endif
-      delay(delayMS);
+      #ifdef WIRED_CHUCK
+        // spend the rest of the tick reading the wired chuck
+        elapsedMillis sinceSample = 0;
+        while (timeElapsed < LOOP_MS) {
+          if (sinceSample >= WIRED_SAMPLE_MS) {
+            chuck.sample();
+            sinceSample = 0;
+          }
+        }
+      #else
+        delay(delayMS);
+      #endif
     }
   } // if (!chuck.isActive()) - else
 } // loop()
@@ -0,0 +1,105 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+#ifndef WIREDCHUCK_H
+#define WIREDCHUCK_H
+
+#include <Wire.h>
+#include "Nunchuck.h"
+
+#define WIRED_SAMPLE_MS 5       // between extra reads (sample()) within a tick
+
+
+/*
+ * WiredChuck: a nunchuck on the base's own I2C (A4/A5), read by the
+ * same Nunchuck class as the Chuck reads its own -- frame filter,
+ * decode and activity window -- and delivered as a ControlFrame so it
+ * goes through the same Chuck::_computeStatus() as the radio.
+ *
+ * CF_ACTIVE is the Nunchuck's activity test, so a frozen or unplugged
+ * wired chuck reads inactive within WII_ACTIVITY_MS + a tick, the same
+ * as a radio one.  That test wants more reads than one a tick: sample()
+ * every WIRED_SAMPLE_MS in between.
+ *
+ * ex:
+ *   wired.setup();
+ *   ControlFrame frame;
+ *   if (wired.read(&frame)) { ... }
+ *   wired.sample();            // ... until the next tick
+ */
+class WiredChuck {
+  private:
+    Nunchuck chuck;
+    byte seq;
+
+
+    word _rejects(void) {
+      return chuck.filterStats.shortFrames + chuck.filterStats.implausible
+             + chuck.filterStats.jumps;
+    } // word _rejects()
+
+
+  public:
+
+    void setup(void) {
+      chuck.setup();
+      seq = 0;
+    } // setup()
+
+
+    // read one frame; false if the filter threw it away (the last good
+    // one stands, and goes stale)
+    bool read(ControlFrame *frame) {
+      word rejects = _rejects();
+      chuck.update();
+      if (_rejects() != rejects) {
+        return false;
+      }
+      frame->stickX = chuck.frame.joyX << 2;
+      frame->stickY = chuck.frame.joyY << 2;
+      frame->buttons = (chuck.C ? CF_BUTTON_C : 0)
+                     | (chuck.Z ? CF_BUTTON_Z : 0)
+                     | (chuck.isActive() ? CF_ACTIVE : 0);
+      frame->seq = seq++;
+      frame->battery = 15;      // board powered
+      frame->extras = false;    // no link to time, nor hop
+      frame->stamp = 0;
+      frame->hop = 0;
+      frame->throttle = 0;
+      return true;
+    } // bool read(frame)
+
+
+    // another read, for the activity test only
+    void sample(void) {
+      chuck.sample();
+    } // sample()
+}; // class WiredChuck
+
+#endif
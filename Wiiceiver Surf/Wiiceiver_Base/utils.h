@@ -125,10 +125,8 @@ byte readSetting(int eeprom_addy, byte default_value) {
 } // byte readSetting(int eeprom_addy, byte default_value)
 
 
-// reads the acceleration profile setting (default: 2) and returns a
-// multiplier [0.5 .. zillion]
-float getProfileMultiplier(void) {
-    byte accelProfile = readSetting(EEPROM_ACCELPROFILE_ADDY, 2);
+// the multiplier [0.5 .. zillion] for an acceleration profile (0..6)
+float profileMultiplier(byte accelProfile) {
     float multiplier = 1.0;
     
     switch (accelProfile) {
@@ -156,6 +154,13 @@ float getProfileMultiplier(void) {
         break;
     }
     return multiplier;
+} // float profileMultiplier(accelProfile)
+
+
+// reads the acceleration profile setting (default: 2) and returns a
+// multiplier [0.5 .. zillion]
+float getProfileMultiplier(void) {
+    return profileMultiplier(readSetting(EEPROM_ACCELPROFILE_ADDY, 2));
 } // float getProfileMultiplier()
 
 
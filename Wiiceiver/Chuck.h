@@ -30,6 +30,30 @@
 #ifndef CHUCK_H
 #define CHUCK_H
 
+/*
+ * One fully decoded nunchuck frame.  On the wire (6 bytes):
+ *   [0] stick X, [1] stick Y
+ *   [2], [3], [4] accelerometer X, Y, Z: bits 9..2
+ *   [5] bits 7..2: accelerometer Z, Y, X bits 1..0 (2 each)
+ *       bit 1: C, bit 0: Z (active low)
+ */
+struct ChuckFrame {
+  byte joyX, joyY;              // raw stick, [0 .. 255]
+  word accelX, accelY, accelZ;  // raw accelerometers, [0 .. 1023]
+  byte buttons;                 // CHUCK_FRAME_C | CHUCK_FRAME_Z; 1 == pressed
+};
+#define CHUCK_FRAME_Z B00000001
+#define CHUCK_FRAME_C B00000010
+
+
+// counts of I2C reads thrown away by the frame filter
+struct ChuckFilterStats {
+  word shortFrames;   // fewer (or more) than 6 bytes
+  word implausible;   // all 0x00 / 0xFF, or stick outside WII_STICK_MIN..MAX
+  word jumps;         // moved too far in one read, and not confirmed
+};
+
+
 /*
  *  A "tiny" Wii Nunchuck class
  *  Borrows heavily from:
@@ -59,58 +83,282 @@
  *
  */
 class Chuck {
-#ifndef WII_ACTIVITY_COUNTER
-#define WII_ACTIVITY_COUNTER 250  // consecutive static reads & it's considered inactive
+#ifndef WII_ACTIVITY_MS
+#define WII_ACTIVITY_MS 160           // accelerometers frozen this long -> inactive (< 200ms)
+#endif
+#ifndef WII_ACTIVITY_READS
+#define WII_ACTIVITY_READS 24         // ... across at least this many reads (host/activity)
+#endif
+#ifndef WII_STICK_MIN
+#define WII_STICK_MIN 0               // raw stick values outside this are garbage; a stick
+#define WII_STICK_MAX 255             // that rails reads 0 / 255 at full deflection
 #endif
+#ifndef WII_MAX_STICK_STEP
+#define WII_MAX_STICK_STEP 64         // max believable change per read, raw units
+#define WII_MAX_ACCEL_STEP 64         // ... on the accelerometer high bytes
+#endif
+#ifndef WII_OVERSAMPLE
+#define WII_OVERSAMPLE 5              // median of the last N stick samples
+#endif
+#define WII_BENCH_STEP 100            // BENCHMARKING_CHUCK: injected stick step, raw units
 #define DEFAULT_Y_ZERO 128
 #define DEFAULT_X_ZERO 128
 
 private:
-  byte status[6], lastStatus[6];
+  byte status[6];
   byte Y0, Ymin, Ymax, X0, Xmin, Xmax;
-  word lastActivity, activitySamenessCount;
+  word lastActivity;
+  byte still[4];                           // accelerometer bytes unchanged ...
+  unsigned long stillMS;                   // ... since
+  byte stillReads;                         // ... for this many reads (up to WII_ACTIVITY_READS)
+  bool moved, quiet;
+  word quietCount;                         // times the chuck went quiet
+#ifdef BENCHMARKING_ACTIVITY
+  unsigned long benchMS, heldReads, heldQuiet;
+#endif
+  byte pending[6];                         // an unconfirmed big jump
+  bool hasPending, hasGood;
+  byte joyXSamples[WII_OVERSAMPLE], joyYSamples[WII_OVERSAMPLE];
+  byte sampleIndex, nrSamples;
+#ifdef BENCHMARKING_CHUCK
+  unsigned long rawJitter, filteredJitter;  // sum of |change| per update
+  word benchUpdates, benchSamples;
+  byte lastRawY, lastFilteredY;
+  unsigned long stepUS;                    // micros() a stick step went in; 0: none
+  unsigned long rawStepUS, medianStepUS;   // step -> seen by update(): raw, median
+  byte stepFrom, stepSamples, benchSettle;
+#endif
 public:
   float X, Y;
   bool C, Z;
+  ChuckFrame frame;
+  ChuckFilterStats filterStats;
 
 
 private:
 
-  bool all255s(void) {
-    for (int i=0; i < 6; i++) {
-      if (status[i] != 255) {
-        return false;
-      }
+  // a held chuck's accelerometers never sit still for long, even at a
+  // fraction of an LSB of noise; a frozen link or an unplugged chuck
+  // (whose last good frame repeats) reads exactly the same forever.
+  // Every read counts, and every axis must hold -- their sum could
+  // cancel out.  Quiet once none has moved for WII_ACTIVITY_MS and
+  // WII_ACTIVITY_READS reads.
+  void _updateActivity(void) {
+    unsigned long now = millis();
+    byte lsbs = status[5] & B11111100;     // not the buttons
+    if (stillReads == 0 || status[2] != still[0] || status[3] != still[1]
+        || status[4] != still[2] || lsbs != still[3]) {
+      moved = moved || stillReads > 0;
+      memcpy(still, status + 2, 3);
+      still[3] = lsbs;
+      stillMS = now;
+      stillReads = 0;
     }
-    return true;
-  } // bool all255s(void)
-
-
-  bool statusChanged(void) {
-    for (int i=0; i < 6; i++) {
-      if (status[i] != lastStatus[i]) {
-        return true;
-      }
+    if (stillReads < WII_ACTIVITY_READS) {
+      stillReads ++;
     }
-    
-    return false;
-  } // bool statusChanged()
+    bool nowQuiet = stillReads == WII_ACTIVITY_READS && now - stillMS >= WII_ACTIVITY_MS;
+    if (nowQuiet && !quiet) {
+      quietCount ++;
+    }
+    quiet = nowQuiet;
+#ifdef BENCHMARKING_ACTIVITY
+    _benchActivity(now);
+#endif
+  } // _updateActivity(void)
   
   
-  void saveLastStatus(void) {
-    for (int i=0; i < 6; i++) {
-      lastStatus[i] = status[i];
+  void _resetActivity(void) {
+    stillReads = 0;
+    moved = quiet = false;
+  } // void _resetActivity()
+
+
+#ifdef BENCHMARKING_ACTIVITY
+  /*
+   * false positives: a stick off center or a button down means a thumb
+   * on the chuck, so any read judged quiet then is wrong.  Once a
+   * minute, print how many held reads were.
+   */
+  void _benchActivity(unsigned long now) {
+    bool held = C || Z || abs(X) > 0.1 || abs(Y) > 0.1;
+    if (held && moved) {
+      heldReads ++;
+      heldQuiet += quiet;
+    }
+    if (now - benchMS >= 60000) {
+      Serial.print(F("Activity: quiet in "));
+      Serial.print(heldQuiet);
+      Serial.print(F(" of "));
+      Serial.print(heldReads);
+      Serial.print(F(" held reads ("));
+      Serial.print(heldReads ? 100.0 * heldQuiet / heldReads : 0, 3);
+      Serial.print(F("% false positives), "));
+      Serial.print(WII_ACTIVITY_MS);
+      Serial.println(F("ms"));
+      benchMS = now;
+      heldReads = heldQuiet = 0;
     }
-  } // void saveLastStatus()
+  } // _benchActivity(now)
+#endif
 
   
+  // a real frame is never all zeros or all ones; the stick range is
+  // only checked if it's been narrowed (for chucks whose rails are garbage)
+  bool _plausible(byte *buf) {
+    byte ones = 0xFF, zeros = 0;
+    for (int i = 0; i < 6; i++) {
+      ones &= buf[i];
+      zeros |= buf[i];
+    }
+    return ones != 0xFF && zeros != 0
+#if WII_STICK_MIN > 0 || WII_STICK_MAX < 255
+      && buf[0] >= WII_STICK_MIN && buf[0] <= WII_STICK_MAX
+      && buf[1] >= WII_STICK_MIN && buf[1] <= WII_STICK_MAX
+#endif
+      ;
+  } // bool _plausible(buf)
+
+
+  // rate-of-change check of buf against a reference frame
+  bool _withinStep(byte *buf, byte *ref) {
+    return abs(buf[0] - ref[0]) <= WII_MAX_STICK_STEP
+      && abs(buf[1] - ref[1]) <= WII_MAX_STICK_STEP
+      && abs(buf[2] - ref[2]) <= WII_MAX_ACCEL_STEP
+      && abs(buf[3] - ref[3]) <= WII_MAX_ACCEL_STEP
+      && abs(buf[4] - ref[4]) <= WII_MAX_ACCEL_STEP;
+  } // bool _withinStep(buf, ref)
+
+
+  /*
+   * validate a freshly read frame of cnt bytes; returns true if it
+   * should replace status[].  A big jump is held back one read: it's
+   * accepted only if the next frame agrees with it.  Otherwise status[]
+   * keeps the last good frame.
+   */
+  bool _acceptFrame(byte *buf, int cnt) {
+    if (cnt != 6) {
+      filterStats.shortFrames ++;
+      return false;
+    }
+    if (! _plausible(buf)) {
+      filterStats.implausible ++;
+      return false;
+    }
+    if (! hasGood || _withinStep(buf, status) 
+        || (hasPending && _withinStep(buf, pending))) {
+      hasGood = true;
+      hasPending = false;
+      return true;
+    }
+    filterStats.jumps ++;
+    memcpy(pending, buf, sizeof(pending));
+    hasPending = true;
+    return false;
+  } // bool _acceptFrame(buf, cnt)
+
+
+  // unpack all 6 bytes of status[] into frame; straight-line, no
+  // branches, so it costs the same every tick
+  void _decodeFrame(void) {
+    byte lsbs = status[5];
+    frame.joyX = status[0];
+    frame.joyY = status[1];
+    frame.accelX = (status[2] << 2) | ((lsbs >> 2) & B00000011);
+    frame.accelY = (status[3] << 2) | ((lsbs >> 4) & B00000011);
+    frame.accelZ = (status[4] << 2) | (lsbs >> 6);
+    frame.buttons = ~lsbs & (CHUCK_FRAME_C | CHUCK_FRAME_Z);
+  } // _decodeFrame(void)
+
+  
+  // median of the first n entries of samples[] (n <= WII_OVERSAMPLE)
+  byte _median(byte *samples, byte n) {
+    byte sorted[WII_OVERSAMPLE];
+    for (byte i = 0; i < n; i++) {
+      byte value = samples[i];
+      byte j = i;
+      while (j > 0 && sorted[j-1] > value) {
+        sorted[j] = sorted[j-1];
+        j--;
+      }
+      sorted[j] = value;
+    }
+    return sorted[n / 2];
+  } // byte _median(samples, n)
+
+
+#ifdef BENCHMARKING_CHUCK
+  /*
+   * latency: once a report, sample() adds a step of WII_BENCH_STEP to
+   * the stick; time it to the first update() (what a single sample per
+   * tick would see) and to the update() whose median has moved half way.
+   * The throttle sees the step too: bench only.
+   */
+  void _benchStep(void) {
+    if (stepUS == 0) {
+      return;
+    }
+    if (rawStepUS == 0 && stepSamples > 0) {
+      rawStepUS = micros() - stepUS;
+    }
+    if (abs(frame.joyY - stepFrom) >= WII_BENCH_STEP / 2) {
+      medianStepUS = micros() - stepUS;
+      stepUS = 0;
+      benchSettle = 2;
+    }
+  } // _benchStep(void)
+#endif
+
+
+  // replace the stick in frame with the median of the recent samples
+  void _filterStick(void) {
+#ifdef BENCHMARKING_CHUCK
+    byte rawY = frame.joyY;
+#endif
+    frame.joyX = _median(joyXSamples, nrSamples);
+    frame.joyY = _median(joyYSamples, nrSamples);
+#ifdef BENCHMARKING_CHUCK
+    _benchStep();
+    if (stepUS != 0 || benchSettle > 0) {
+      benchSettle -= benchSettle > 0;   // a step's still in the window
+    } else {
+      rawJitter += abs(rawY - lastRawY);
+      filteredJitter += abs(frame.joyY - lastFilteredY);
+    }
+    lastRawY = rawY;
+    lastFilteredY = frame.joyY;
+    if (++benchUpdates == 250) {
+      Serial.print(F("Chuck: "));
+      Serial.print(1.0 * benchSamples / benchUpdates);
+      Serial.print(F(" samples/update; Y jitter raw="));
+      Serial.print(1.0 * rawJitter / benchUpdates, 3);
+      Serial.print(F(", median="));
+      Serial.print(1.0 * filteredJitter / benchUpdates, 3);
+      Serial.print(F(" per update; step latency raw="));
+      Serial.print(rawStepUS);
+      Serial.print(F("us, median="));
+      Serial.print(medianStepUS);
+      Serial.print(F("us ("));
+      Serial.print(stepSamples);
+      Serial.println(F(" samples)"));
+      rawJitter = filteredJitter = 0;
+      benchUpdates = benchSamples = 0;
+      stepUS = micros();        // the next sample()s carry a step
+      stepFrom = frame.joyY;
+      stepSamples = 0;
+      rawStepUS = medianStepUS = 0;
+    }
+#endif
+  } // _filterStick(void)
+
+
   // tracks the max-observed deflection (high & low)
   void _selfCalibrateDeflection(void) {
-    byte joyX = status[0];
+    byte joyX = frame.joyX;
     Xmin = min(joyX, Xmin);
     Xmax = max(joyX, Xmax);
  
-    byte joyY = status[1];
+    byte joyY = frame.joyY;
 
     if (joyY < Ymin) {
       Ymin = joyY;
@@ -123,8 +371,10 @@ private:
 
 
   void _computeStatus(void) {
-    byte joyX = status[0];
-    byte joyY = status[1];
+    _decodeFrame();
+    _filterStick();
+    byte joyX = frame.joyX;
+    byte joyY = frame.joyY;
     _selfCalibrateDeflection();
     
     int centeredX = joyX - X0;
@@ -149,19 +399,10 @@ private:
       Y = -1.0 * centeredY / (Ymin - Y0); 
     }
 
-    C = ((status[5] & B00000010) >> 1) == 0;
-    Z = (status[5] & B00000001) == 0;
+    C = frame.buttons & CHUCK_FRAME_C;
+    Z = frame.buttons & CHUCK_FRAME_Z;
 
 
-    if (!statusChanged()) { 
-      if (activitySamenessCount < WII_ACTIVITY_COUNTER) {
-        activitySamenessCount ++;
-      }
-    } else {
-      activitySamenessCount = 0;
-      saveLastStatus();
-    }
-    
 #ifdef DEBUGGING_CHUCK_ACTIVITY
     Serial.print("CHUCK: ");
     for (int i = 0; i < 5; i++) {
@@ -169,8 +410,10 @@ private:
       Serial.print(status[i], DEC);
       Serial.print("]");
     }
-    Serial.print("; sameness ");
-    Serial.print(activitySamenessCount);    
+    Serial.print("; still ");
+    Serial.print(stillReads);
+    Serial.print(", quiet #");
+    Serial.print(quietCount);    
     Serial.println();
 #endif
 
@@ -243,8 +486,11 @@ public:
     Serial.print(millis());
 #endif
 
-    // do enough updates to prime the activity checker ...
-    for (int i = 0; i < WII_ACTIVITY_COUNTER; i++) {
+    // prime the frame filters, until the accelerometers move (active)
+    _resetActivity();
+    hasGood = hasPending = false;
+    sampleIndex = nrSamples = 0;
+    for (int i = 0; i < WII_ACTIVITY_READS && !moved; i++) {
       update();
       delay(1);
     }
@@ -256,40 +502,107 @@ public:
   } // void setup(void)
 
 
-  // update the status[] fields from the nunchuck
-  void update(void) {
-    // TODO: estimate the actual delay required between the request 
-    // & data available on bus
-    // delay(1);
-
+  /*
+   * take one reading from the nunchuck: status[] gets the newest good
+   * frame, the stick goes into the median window and the activity test
+   * gets another read.  Call this several times per tick (WII_OVERSAMPLE)
+   * between update()s.
+   */
+  void sample(void) {
     // read 6 bytes
     Wire.requestFrom (0x52, 6); // request data from nunchuck
+    byte buf[6];
     int cnt = 0;
     while (Wire.available()) {
-      status[cnt] = Wire.read();
+      byte b = Wire.read();
+      if (cnt < 6) {
+        buf[cnt] = b;
+      }
       cnt++;
     }
 
-    _computeStatus();
-#ifdef DEBUGGING_CHUCK_ACTIVITY
-   Serial.print("Active? ");
-   Serial.println(isActive() ? "yes" : "no");
+    // a rejected frame repeats the last good one
+    if (_acceptFrame(buf, cnt)) {
+      memcpy(status, buf, sizeof(status));
+    }
+#ifdef DEBUGGING_CHUCK_FILTER
+    else {
+      printFilterStats();
+    }
+#endif
+    _updateActivity();
+
+    joyXSamples[sampleIndex] = status[0];
+    joyYSamples[sampleIndex] = status[1];
+#ifdef BENCHMARKING_CHUCK
+    if (stepUS != 0) {
+      joyYSamples[sampleIndex] += status[1] < 128 ? WII_BENCH_STEP : -WII_BENCH_STEP;
+      stepSamples ++;
+    }
+#endif
+    sampleIndex = (sampleIndex + 1) % WII_OVERSAMPLE;
+    if (nrSamples < WII_OVERSAMPLE) {
+      nrSamples ++;
+    }
+#ifdef BENCHMARKING_CHUCK
+    benchSamples ++;
 #endif
 
     // send one 0 to initiate transfer
     Wire.beginTransmission(0x52); 
     Wire.write(0);         
     Wire.endTransmission();
+  } // void sample(void)
 
+
+  // update the status fields from the nunchuck: one fresh sample, 
+  // filtered with whatever sample()s came since the last update
+  void update(void) {
+    sample();
+    _computeStatus();
+#ifdef DEBUGGING_CHUCK_ACTIVITY
+   Serial.print("Active? ");
+   Serial.println(isActive() ? "yes" : "no");
+#endif
   } // void update(void)
 
 
   // is the controller "active" -- being held by a human & reporting
   // changing values?
   bool isActive(void) {
-    return activitySamenessCount < WII_ACTIVITY_COUNTER && ! all255s();
+    return moved && !quiet;
   } // bool isActive(void)
 
+
+  void printFilterStats(void) {
+    Serial.print(F("Chuck rejects: short="));
+    Serial.print(filterStats.shortFrames);
+    Serial.print(F(", implausible="));
+    Serial.print(filterStats.implausible);
+    Serial.print(F(", jumps="));
+    Serial.println(filterStats.jumps);
+  } // printFilterStats()
+
+
+#ifdef BENCHMARKING_CHUCK
+  // time the frame decoder; prints the average cost per decode
+  void benchmarkDecode(void) {
+    byte saved = status[5];
+    unsigned long startUS = micros();
+    for (int i = 0; i < 1000; i++) {
+      status[5] = i;
+      _decodeFrame();
+      asm volatile("" ::: "memory");  // keep every pass
+    }
+    unsigned long elapsedUS = micros() - startUS;
+    status[5] = saved;
+    _decodeFrame();
+    Serial.print(F("Chuck::_decodeFrame(): "));
+    Serial.print(elapsedUS / 1000.0, 3);
+    Serial.println(F(" us per frame"));
+  } // benchmarkDecode()
+#endif
+
 };
 
 #endif
@@ -30,18 +30,131 @@
 #ifndef SMOOTHER_H
 #define SMOOTHER_H
 
+#include <avr/pgmspace.h>
+#include "Pipeline.h"
+
 /*
- * A helper class -- smooths the throttle input
- * 
+ * The smoothing programs, by number (SMOOTHER_*_PROGRAM, from the sketch):
+ * how fast the ceiling rises & falls (per second), and the smoothing time
+ * constant (seconds; 0 == none).
+ *
+ * Each is a compile-time constant, SmootherProgram<N>, for smooth<N>();
+ * the same numbers are in smootherPrograms[] (flash) for the odd caller 
+ * that picks a program at runtime.
  */
+template <int Program> struct SmootherProgram;
 
-class Smoother {
+#define SMOOTHER_PROGRAM(PROGRAM, INCR, DECR, TAU) \
+  template <> struct SmootherProgram<PROGRAM> { \
+    static constexpr float incr = INCR, decr = DECR, tau = TAU; \
+  }
+
+//                                              INCR/s, DECR/s, TAU (s)
+SMOOTHER_PROGRAM(SMOOTHER_BRAKES_PROGRAM,          0.00,  0.50,  0.00);
+SMOOTHER_PROGRAM(SMOOTHER_THROTTLE_PROGRAM,        0.20,  0.25,  0.19);
+SMOOTHER_PROGRAM(SMOOTHER_THROTTLE_Z_PROGRAM,     50.00, 50.00,  0.00);
+SMOOTHER_PROGRAM(SMOOTHER_CRUISE_RESUME_PROGRAM,   0.20,  0.25,  0.19);
+
+#define SMOOTHER_PROGRAM_ROW(PROGRAM) \
+  { SmootherProgram<PROGRAM>::incr, SmootherProgram<PROGRAM>::decr, \
+    SmootherProgram<PROGRAM>::tau }
+
+// in program number order
+const float smootherPrograms[][3] PROGMEM = {
+  SMOOTHER_PROGRAM_ROW(SMOOTHER_BRAKES_PROGRAM),
+  SMOOTHER_PROGRAM_ROW(SMOOTHER_THROTTLE_PROGRAM),
+  SMOOTHER_PROGRAM_ROW(SMOOTHER_THROTTLE_Z_PROGRAM),
+  SMOOTHER_PROGRAM_ROW(SMOOTHER_CRUISE_RESUME_PROGRAM),
+};
+
+
+/*
+ * Ceiling: a moving ceiling over the target; a rising target is held to
+ * the ceiling, which rises at incr per second.  Under the ceiling the
+ * target passes straight through, while the ceiling falls at decr per
+ * second (never below 0.2).  A Pipeline stage.
+ */
+class Ceiling {
   private:
+    float incr, decr;
+    float ceiling;
+
+  public:
+    Ceiling(void) {
+      set(0, 0);
+      zero();
+    } // Ceiling()
+
+    void set(float incr_, float decr_) {
+      incr = incr_;
+      decr = decr_;
+    } // set(incr, decr)
+
+    float run(float target, float dt) {
+      float returnValue = target;
+
+#ifdef DEBUGGING_SMOOTHER
+      Serial.print("; target = ");
+      Serial.print(target, 4);
+      Serial.print(", ceiling: ");
+      Serial.print(ceiling, 4);
+#endif
+
+      if (target > ceiling) {
+        ceiling += incr * dt;
+        if (ceiling > target) { // avoid hunting
+          ceiling = target;
+          ceiling = min(ceiling, 1.0);
+        }
+        returnValue = ceiling;
+      } else if (target < ceiling) {
+        ceiling -= decr * dt;
+        if (ceiling < target) { // avoid hunting
+          ceiling = target;
+        }
+        ceiling = max(ceiling, 0.0);
+        returnValue = target; 
+      }
+       
+      ceiling = max(ceiling, 0.2);
+
+#ifdef DEBUGGING_SMOOTHER
+      Serial.print(", next: ");
+      Serial.print(returnValue);
+      Serial.print(", new ceiling: ");
+      Serial.print(ceiling, 4);
+#endif
+      return returnValue;
+    } // float run(target, dt)
+
+    void zero(void) {
+      ceiling = 0;
+    } // zero()
+}; // class Ceiling
+
+
+/*
+ * Expo: exponential smoothing with a time constant of tau seconds
+ * (0 == none); steps slower than SMOOTHER_MIN_RATE snap to the target.
+ * A Pipeline stage.
+ */
+class Expo {
+  private:
+    float tau;
     float value;
-    float ceiling; 
-    
-    // compute a new smoothed value
-    float compute(float target, float factor) {
+
+  public:
+    Expo(void) {
+      set(0);
+      zero();
+    } // Expo()
+
+    void set(float tau_) {
+      tau = tau_;
+    } // set(tau)
+
+    float run(float target, float dt) {
+      float factor = tau > 0 ? 1.0 - exp(-dt / tau) : 1.0;
       float step = (target - value) * factor;
       
 #ifdef DEBUGGING_SMOOTHER
@@ -55,7 +168,7 @@ class Smoother {
       Serial.print(step, 4);
 #endif
 
-      if (abs(step) < SMOOTHER_MIN_STEP) {
+      if (abs(step) < SMOOTHER_MIN_RATE * dt) {
 #ifdef DEBUGGING_SMOOTHER
       Serial.print(" BUMP");
 #endif
@@ -69,82 +182,134 @@ class Smoother {
       Serial.println(value, 4);
 #endif
       return value;
-    }  // float compute(float target, float factor)
+    } // float run(target, dt)
+
+    void zero(void) {
+      value = 0;
+    } // zero()
+}; // class Expo
+
+
+typedef Pipeline<Ceiling, Expo> SkatePipeline;
+
+
+/*
+ * A helper class -- smooths the throttle input: a SkatePipeline, with
+ * the numbers from one of the programs
+ * 
+ * ex:
+ *   throttle = smoother.smooth<SMOOTHER_THROTTLE_PROGRAM>(chuck.Y, dt);
+ *   throttle = smoother.smooth(chuck.Y, program, dt);   // from flash
+ */
+
+class Smoother {
+  private:
+    SkatePipeline pipeline;
+    
+
+    // the moving ceiling (see smooth()), for one program's numbers
+    float _smooth(float target, float incr, float decr, float tau, float dt) {
+      pipeline.get<Ceiling>().set(incr, decr);
+      pipeline.get<Expo>().set(tau);
+      return pipeline.run(target, dt);
+    } // float _smooth(target, incr, decr, tau, dt)
+
+
+#ifdef BENCHMARKING_SMOOTHER
+    // the old way, for comparison: the table built on the stack per call
+    float _smoothStack(float target, int program, float dt) {
+      float programMap[5][3] = {
+          { 0.00,  0.50,  0.00}, // BRAKES
+          { 0.20,  0.25,  0.19}, // THROTTLE
+          {50.00, 50.00,  0.00}, // THROTTLE + Z
+          { 0.20,  0.25,  0.19}, // "resume" cruise
+      };
+      return _smooth(target, programMap[program][0], programMap[program][1],
+                     programMap[program][2], dt);
+    } // float _smoothStack(target, program, dt)
+#endif
 
 
   public:
     Smoother(void) {
-      value = 0;
-      ceiling = 0;
+      zero();
     }
 
 
     // the main "smooth" function -- actually computes a moving ceiling, and 
     // reacts more aggressively under that ceiling.  Net result is (meant to 
     // be) a responsive throttle *eith* a reasonable acceleration limit.
-    float smooth(float target, int program) {
-      #define INCR 0
-      #define DECR 1
-      #define SMOOTHNESS 2
-      float programMap[5][3] = {
-        // INCR,  DECR,  SMOOTHNESS
-          {0.000, 0.010, 1.00}, // BRAKES
-          {0.004, 0.005, 0.10}, // THROTTLE
-          {1.000, 1.000, 1.00}, // THROTTLE + Z
-          {0.004, 0.005, 0.10}, // "resume" cruise
-      };
-      float returnValue = target;
-
+    //
+    // dt is the time (seconds) since the last call; the rates are per
+    // second, so the loop can run at any rate.
+    template <int Program> 
+    float smooth(float target, float dt) {
 #ifdef DEBUGGING_SMOOTHER
       Serial.print("Adap2ive: program #");
-      Serial.print(program);
-      Serial.print("; target = ");
-      Serial.print(target, 4);
-      Serial.print(", ceiling: ");
-      Serial.print(ceiling, 4);
-#endif
-
-      if (target > ceiling) {
-        ceiling += programMap[program][INCR];
-        if (ceiling > target) { // avoid hunting
-          ceiling = target;
-          ceiling = min(ceiling, 1.0);
-        }
-        returnValue = ceiling;
-      } else if (target < ceiling) {
-        ceiling -= programMap[program][DECR];
-        if (ceiling < target) { // avoid hunting
-          ceiling = target;
-        }
-        ceiling = max(ceiling, 0.0);
-        returnValue = target; 
-      }
-       
-      ceiling = max(ceiling, 0.2);
-
-#ifdef DEBUGGING_SMOOTHER
-      Serial.print(", next: ");
-      Serial.print(returnValue);
-      Serial.print(", new ceiling: ");
-      Serial.print(ceiling, 4);
+      Serial.print(Program);
 #endif
+      return _smooth(target, SmootherProgram<Program>::incr, 
+                     SmootherProgram<Program>::decr, 
+                     SmootherProgram<Program>::tau, dt);
+    } // float smooth<Program>(float target, float dt)
 
-      returnValue = compute(returnValue, programMap[program][SMOOTHNESS]);
 
+    // ... with the program chosen at runtime, from smootherPrograms[]
+    float smooth(float target, int program, float dt) {
 #ifdef DEBUGGING_SMOOTHER
-      Serial.print(", returning: ");
-      Serial.println(returnValue, 4);
+      Serial.print("Adap2ive: program #");
+      Serial.print(program);
 #endif
-
-      return returnValue;
-    } // float smooth(float target, int program)
+      return _smooth(target, pgm_read_float(&smootherPrograms[program][0]),
+                     pgm_read_float(&smootherPrograms[program][1]),
+                     pgm_read_float(&smootherPrograms[program][2]), dt);
+    } // float smooth(float target, int program, float dt)
 
 
     // reset the internal smoothing value, to quickly seek zero
     void zero() {
-      value = 0;
-      ceiling = 0;
+      pipeline.zero();
     } // void zero()
+
+
+#ifdef BENCHMARKING_SMOOTHER
+    // time the three ways in: per call, stack table (old) vs flash
+    // table vs compile-time program
+    void benchmarkSmooth(void) {
+      SkatePipeline saved = pipeline;
+      unsigned long stackUS, flashUS, templateUS, startUS;
+      
+      startUS = micros();
+      for (int i = 0; i < 1000; i++) {
+        _smoothStack((i & 0xff) / 255.0, SMOOTHER_THROTTLE_PROGRAM, 0.02);
+        asm volatile("" ::: "memory");  // keep every pass
+      }
+      stackUS = micros() - startUS;
+      
+      startUS = micros();
+      for (int i = 0; i < 1000; i++) {
+        smooth((i & 0xff) / 255.0, SMOOTHER_THROTTLE_PROGRAM, 0.02);
+        asm volatile("" ::: "memory");
+      }
+      flashUS = micros() - startUS;
+      
+      startUS = micros();
+      for (int i = 0; i < 1000; i++) {
+        smooth<SMOOTHER_THROTTLE_PROGRAM>((i & 0xff) / 255.0, 0.02);
+        asm volatile("" ::: "memory");
+      }
+      templateUS = micros() - startUS;
+      
+      pipeline = saved;
+      Serial.print(F("Smoother::smooth(): stack table "));
+      Serial.print(stackUS / 1000.0, 3);
+      Serial.print(F(" us, flash table "));
+      Serial.print(flashUS / 1000.0, 3);
+      Serial.print(F(" us, compile-time "));
+      Serial.print(templateUS / 1000.0, 3);
+      Serial.println(F(" us per call"));
+    } // benchmarkSmooth()
+#endif
 };
 
 #endif
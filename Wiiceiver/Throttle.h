@@ -30,8 +30,7 @@
 #ifndef THROTTLE_H
 #define THROTTLE_H
 
-// not strictly necessary, but a nice reminder
-#include "Chuck.h"
+#include "ControlInput.h"
 #include "Smoother.h"
 
 
@@ -42,7 +41,7 @@
 class Throttle {
   private:
     float autoCruise, throttle, previousCruiseLevel;
-    int xCounter;
+    float xHeld;                // seconds holding X for autoCruise
     Smoother smoother;
     
     
@@ -78,34 +77,36 @@ class Throttle {
     /*
      * returns 'true' if we're in a "set autocruise level" state:
      *   while in cruise (chuck.C), with no throttle input (chuck.Y =~ 0), 
-     *   holding Z, full X deflection (chuck.X > 0.75) ... for N cycles,
+     *   holding Z, full X deflection (chuck.X > 0.75) ... for 
+     *   THROTTLE_AUTOCRUISE_HOLD seconds (dt: seconds since the last call),
      *   within 2 minutes of startup ...
      * set "autoCruise" to the current throttle level.
      *   
      */
-    bool checkAutoCruise(Chuck chuck) {
+    bool checkAutoCruise(const ControlInput& chuck, float dt) {
       if (! chuck.C) {
         #ifdef DEBUGGING_THROTTLE_CAC
         Serial.println("checkAutoCruise: no C");
         #endif
-        xCounter = 0;
+        xHeld = 0;
         return false;
       }
       if (millis() < 120 * 1000 &&
           chuck.Z &&
           abs(chuck.Y) < 0.25 && 
           abs(chuck.X) > 0.75) {
-        ++xCounter;
-        #ifdef DEBUGGING_THROTTLE_CAC
-        Serial.print("checkAutoCruise: xCounter = ");
-        Serial.println(xCounter);
-        #endif
-        if (xCounter == 150) { // ~3s holding X
+        if (xHeld < THROTTLE_AUTOCRUISE_HOLD 
+            && xHeld + dt >= THROTTLE_AUTOCRUISE_HOLD) {
           writeAutoCruise();  
         }
+        xHeld += dt;
+        #ifdef DEBUGGING_THROTTLE_CAC
+        Serial.print("checkAutoCruise: xHeld = ");
+        Serial.println(xHeld);
+        #endif
         return true;
       } else {
-        xCounter = 0;
+        xHeld = 0;
         #ifdef DEBUGGING_THROTTLE_CAC
         Serial.println("checkAutoCruise: no X or Y");
         Serial.print("x = ");
@@ -115,7 +116,7 @@ class Throttle {
         #endif        
         return false;
       }
-    } // bool checkAutoCruise(void)
+    } // bool checkAutoCruise(chuck, dt)
     
 
 
@@ -131,7 +132,7 @@ class Throttle {
      *
      * side effects: stores a few states as well as the previousCruise level
      */
-    float checkCruiseReturn(Chuck chuck) {
+    float checkCruiseReturn(const ControlInput& chuck, float dt) {
       static bool previousC;
       static unsigned long previousCruiseMS;
       float newThrottle = 0.0;
@@ -185,7 +186,7 @@ class Throttle {
       }
       
       if (ccrState == CCR_RESUMING) {
-        newThrottle = smoother.smooth(previousCruiseLevel, SMOOTHER_CRUISE_RESUME_PROGRAM);
+        newThrottle = smoother.smooth<SMOOTHER_CRUISE_RESUME_PROGRAM>(previousCruiseLevel, dt);
       } // CCR_RESUMING
 
       #ifdef DEBUGGING_THROTTLE_CCR
@@ -196,7 +197,7 @@ class Throttle {
       
       previousC = chuck.C;
       return newThrottle;
-    } // checkCruiseReturn(Chuck chuck)
+    } // checkCruiseReturn(const ControlInput& chuck, float dt)
 
     
     // returns the throttle position appropriate for cruise
@@ -204,23 +205,24 @@ class Throttle {
     // Theory of Operation:
     //   checkAutoCruise: if looking to setting, don't change throttle
     //   !C -> C: 
-    float cruiseControl(Chuck chuck) {
-      if (checkAutoCruise(chuck)) {                                  // setting auto cruise?
+    // THROTTLE_CC_RATE is per second, at full stick
+    float cruiseControl(const ControlInput& chuck, float dt) {
+      if (checkAutoCruise(chuck, dt)) {                                  // setting auto cruise?
         // we're looking for autoCruise, so do that;
         // don't change the throttle position, just
         // return throttle; fallthrough is OK
       } else if (chuck.Y > 0.25) {                                   // accel?
         // speed up, but not past 1.0 (full blast)
-        throttle += chuck.Y * THROTTLE_CC_BUMP;
+        throttle += chuck.Y * THROTTLE_CC_RATE * dt;
         throttle = min(throttle, 1.0);
       } else if (chuck.Y < -0.25) {                                  // decel?
-        throttle += chuck.Y * THROTTLE_CC_BUMP;
+        throttle += chuck.Y * THROTTLE_CC_RATE * dt;
         throttle = max(throttle, 0.0);
       } else if (throttle < autoCruise) {                            // auto cruise?
-        throttle += 4 * THROTTLE_CC_BUMP;
+        throttle += 4 * THROTTLE_CC_RATE * dt;
       } 
       return throttle;
-    } // float cruiseControl(void)
+    } // float cruiseControl(chuck, dt)
     
     
   public:
@@ -230,7 +232,7 @@ class Throttle {
       smoother = Smoother();
       throttle = 0;
       autoCruise = THROTTLE_MIN_CC;
-      xCounter = 0;
+      xHeld = 0;
     } // Throttle()
     
 
@@ -252,8 +254,11 @@ class Throttle {
      *      if joystick == down, decrement throttle position  (Z button: 3x decrement)
      *   else throttle position == chuck.Y joystick position
      *   return a smoothed value from the throttle position (Z button: 4x less smoothed)
+     *
+     *   dt is the time (seconds) since the last update; all the rates are
+     *   per second
      */
-    float update(Chuck chuck) {
+    float update(const ControlInput& chuck, float dt) {
       #ifdef DEBUGGING_THROTTLE
       Serial.print("Throttle: ");
       Serial.print("y=");
@@ -264,7 +269,7 @@ class Throttle {
       Serial.print("; ");
       #endif
 
-      if (float newThrottle = checkCruiseReturn(chuck)) {
+      if (float newThrottle = checkCruiseReturn(chuck, dt)) {
         // CC return: in CC mode, drop C, then resume shortly after 
         // (with no other input) -- resume the previous CC 
         #ifdef DEBUGGING_THROTTLE
@@ -275,15 +280,17 @@ class Throttle {
         throttle = newThrottle;
       } else if (chuck.C) { 
         // cruise control!
-        throttle = cruiseControl(chuck);
+        throttle = cruiseControl(chuck, dt);
         // don't actually use a smoothed throttle, but keep the smoother algorithm warm
         // so when we drop the cruise, throttle (with stick @ 0) will "smooth" back to neutral
-        smoother.smooth(throttle, SMOOTHER_THROTTLE_PROGRAM);
+        smoother.smooth<SMOOTHER_THROTTLE_PROGRAM>(throttle, dt);
       } else if (chuck.Y < -THROTTLE_MIN) { 
         // brakes!
-        throttle = smoother.smooth(chuck.Y, SMOOTHER_BRAKES_PROGRAM);
+        throttle = smoother.smooth<SMOOTHER_BRAKES_PROGRAM>(chuck.Y, dt);
+      } else if (chuck.Z) {
+        throttle = smoother.smooth<SMOOTHER_THROTTLE_Z_PROGRAM>(chuck.Y, dt);
       } else {
-        throttle = smoother.smooth(chuck.Y, (chuck.Z ? SMOOTHER_THROTTLE_Z_PROGRAM : SMOOTHER_THROTTLE_PROGRAM));
+        throttle = smoother.smooth<SMOOTHER_THROTTLE_PROGRAM>(chuck.Y, dt);
       }
       
       #ifdef DEBUGGING_THROTTLE
@@ -292,7 +299,7 @@ class Throttle {
       #endif
 
       return throttle;
-    } // float update(void)
+    } // float update(chuck, dt)
     
     
     float getThrottle(void) {
@@ -42,12 +42,26 @@
 
 #define DEBUGGING
 
+// control loop period (ms), 5 (200Hz) to 20 (50Hz); the smoothing and
+// cruise rates are per second and the activity window is in ms, so any
+// of them rides the same.  Under 5 there's no room in a tick for the
+// WII_OVERSAMPLE stick reads (~0.7ms each).
+#define LOOP_MS 20
+#define LOOP_MAX_DT 0.1           // s; a longer gap (a stall) counts as this
+
 #include "Blinker.h"
 
 
 // #define DEBUGGING_CHUCK
 // #define DEBUGGING_CHUCK_ACTIVITY
-#define WII_ACTIVITY_COUNTER 100  // once per 20ms; 50 per second
+// #define BENCHMARKING_CHUCK
+// #define BENCHMARKING_ACTIVITY
+#define WII_ACTIVITY_MS 160       // frozen this long (and WII_ACTIVITY_READS reads) -> inactive
+#define WII_OVERSAMPLE 5          // stick samples per update, median filtered
+#define WII_SAMPLE_MS (LOOP_MS / WII_OVERSAMPLE)  // spread across the tick
+#if WII_SAMPLE_MS < 1
+  #error "LOOP_MS is too short for WII_OVERSAMPLE stick reads per tick"
+#endif
 #include "Chuck.h"
 
 
@@ -56,7 +70,8 @@
 
 
 // #define DEBUGGING_SMOOTHER
-#define SMOOTHER_MIN_STEP 0.003           // minimum change for smoothing; 0.003 for ~1s, 0.001 for ~2s
+// #define BENCHMARKING_SMOOTHER
+#define SMOOTHER_MIN_RATE 0.15            // per second; slower smoothing snaps to the target
 #define SMOOTHER_BRAKES_PROGRAM 0
 #define SMOOTHER_THROTTLE_PROGRAM 1
 #define SMOOTHER_THROTTLE_Z_PROGRAM 2
@@ -66,10 +81,11 @@
 
 // #define DEBUGGING_THROTTLE
 #define THROTTLE_MIN 0.05                      // the lowest throttle to send the ESC
-#define THROTTLE_CC_BUMP 0.003                 // CC = 0.2% throttle increase; 50/s = 10s to hit 100% on cruise
+#define THROTTLE_CC_RATE 0.15                  // CC throttle increase per second, full stick; ~7s to hit 100% on cruise
 #define THROTTLE_MIN_CC 0.05                   // minimum / inital speed for cruise crontrol
                                                // note that a different value may be stored in EEPROM
 #define THROTTLE_CRUISE_RETURN_MS 5000         // time (ms) when re-grabbing cruise will use the previous CC level
+#define THROTTLE_AUTOCRUISE_HOLD 3.0           // seconds holding C+Z+X to store autoCruise
 #include "Throttle.h"
 
 
@@ -332,6 +348,7 @@ void handleInactivity() {
 #ifdef DEBUGGING
   Serial.print(millis());
   Serial.println(": handling inactivity");
+  chuck.printFilterStats();
 #endif
   // lastThrottle = 0; // kills cruise control
   // smoother.zero();  // kills throttle history
@@ -405,6 +422,12 @@ void setup() {
 #ifdef DEBUGGING
   Serial.println("Nunchuck is active!");
 #endif
+#ifdef BENCHMARKING_CHUCK
+  chuck.benchmarkDecode();
+#endif
+#ifdef BENCHMARKING_SMOOTHER
+  Smoother().benchmarkSmooth();
+#endif
 
   throttle.init();
 
@@ -418,6 +441,16 @@ void setup() {
 
 
 
+// seconds since the last call, for the throttle's per-second rates
+float tickSeconds(void) {
+  static unsigned long lastUS = micros();
+  unsigned long nowUS = micros();
+  float dt = (nowUS - lastUS) / 1000000.0;
+  lastUS = nowUS;
+  return min(dt, LOOP_MAX_DT);
+} // float tickSeconds()
+
+
 void loop() {
   static float lastThrottleValue = 0;
   unsigned long startMS = millis();
@@ -425,6 +458,7 @@ void loop() {
   green.run();
   red.run();
   chuck.update();
+  float dt = tickSeconds();
   
   // for forcing a watchdog timeout
   #undef SUICIDAL_Z
@@ -442,7 +476,7 @@ void loop() {
 #endif
     handleInactivity();
   } else {
-    float throttleValue = throttle.update(chuck);
+    float throttleValue = throttle.update(ControlInput(chuck), dt);
     ESC.setLevel(throttleValue);
     if (throttleValue != lastThrottleValue) {
       updateLEDs(throttle);
@@ -459,12 +493,20 @@ void loop() {
 #endif
       lastThrottleValue = throttleValue;
     }
-    int delayMS = constrain(startMS + 21 - millis(), 5, 20);
+    int delayMS = constrain(startMS + LOOP_MS + 1 - millis(), LOOP_MS / 4, LOOP_MS);
 #ifdef DEBUGGING_INTERVALS
     Serial.print("sleeping "); 
     Serial.println(delayMS);
 #endif
-    delay(delayMS);
+    // spend the rest of the tick oversampling the stick
+    unsigned long waitMS = millis();
+    unsigned long sampleMS = startMS;
+    while (millis() - waitMS < (unsigned long)delayMS) {
+      if (millis() - sampleMS >= WII_SAMPLE_MS) {
+        chuck.sample();
+        sampleMS = millis();
+      }
+    }
   } // if (chuck.isActive())
 }
 
@@ -0,0 +1,140 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+#ifndef BOARDMODEL_H
+#define BOARDMODEL_H
+
+// a guess at a board & rider; for benchmarks, not for riding
+#define BOARD_MASS      90.0    // kg, board + rider
+#define BOARD_FORCE     300.0   // N at the wheel, full throttle, stalled
+#define BOARD_TOP_SPEED 11.0    // m/s (~40km/h), full throttle, no load
+#define BOARD_BRAKING   400.0   // N, full brake
+#define BOARD_ROLLING   0.015   // rolling resistance coefficient
+#define BOARD_DRAG      0.30    // N per (m/s)^2: 1/2 * rho * Cd * A
+#define BOARD_G         9.81
+
+
+#define RIDER_REACTION_MS 250   // deciding to the thumb moving
+#define RIDER_STICK_TIME  0.15  // s, thumb from center to full
+
+
+/*
+ * BoardModel: straight-line physics for a board on a slope, driven by
+ * the throttle the ESC would get.  Speed never goes negative: the
+ * brakes and friction stop it, and it doesn't roll back.
+ *
+ * The motor's a DC motor behind the ESC: throttle is the voltage, the
+ * back-EMF grows with speed, so the drive falls off in a straight
+ * line from BOARD_FORCE at a standstill to nothing at throttle *
+ * BOARD_TOP_SPEED.  Past that it freewheels; the ESC only brakes
+ * when the throttle's negative.
+ *
+ * ex:
+ *   BoardModel board;
+ *   board.grade = 0.05;              // a 5% climb
+ *   board.step(throttleValue, 0.001);
+ *   ... board.speed (m/s), board.distance (m)
+ */
+class BoardModel {
+  public:
+    float speed, distance;            // m/s, m
+    float grade;                      // rise / run; negative is downhill
+
+
+    BoardModel() {
+      zero();
+    } // BoardModel()
+
+
+    void zero(void) {
+      speed = distance = grade = 0;
+    } // zero()
+
+
+    // throttle [-1 .. 1], for dt seconds
+    void step(float throttle, float dt) {
+      float force = BOARD_MASS * BOARD_G * -grade;
+      if (throttle > 0) {
+        force += max(BOARD_FORCE * (throttle - speed / BOARD_TOP_SPEED), 0);
+      }
+      if (speed > 0) {
+        force -= BOARD_ROLLING * BOARD_MASS * BOARD_G + BOARD_DRAG * speed * speed;
+        if (throttle < 0) {
+          force += throttle * BOARD_BRAKING;
+        }
+      }
+      speed = max(speed + force / BOARD_MASS * dt, 0);
+      distance += speed * dt;
+    } // step(throttle, dt)
+}; // class BoardModel
+
+
+/*
+ * Rider: a thumb on the stick.  decide() is what the rider wants;
+ * RIDER_REACTION_MS later the thumb starts toward it, and takes
+ * RIDER_STICK_TIME to cross from center to full.
+ *
+ * ex:
+ *   Rider rider;
+ *   rider.decide(1.0);               // go!
+ *   ... throttle.update(ControlInput(0, rider.update(dt), false, false), dt);
+ */
+class Rider {
+  private:
+    float intent, wait;
+
+
+  public:
+    float stick;                      // where the thumb has it [-1 .. 1]
+
+
+    Rider() {
+      intent = stick = wait = 0;
+    } // Rider()
+
+
+    void decide(float target) {
+      intent = target;
+      wait = RIDER_REACTION_MS / 1000.0;
+    } // decide(target)
+
+
+    // the stick, dt seconds on
+    float update(float dt) {
+      if (wait > 0) {
+        wait -= dt;
+      } else {
+        float step = dt / RIDER_STICK_TIME;
+        stick = constrain(intent, stick - step, stick + step);
+      }
+      return stick;
+    } // float update(dt)
+}; // class Rider
+
+#endif
@@ -0,0 +1,558 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+#ifndef VIRTUALNRF24_H
+#define VIRTUALNRF24_H
+
+/*
+ * The simulated link; each of these can be -D'd (make link DEFS=...).
+ * Defaults are a poor day: a few % lost, bursts of ~10 frames.
+ */
+#ifndef SIM_LATENCY_MS
+#define SIM_LATENCY_MS 1        // air time + SPI on both ends, roughly
+#endif
+#ifndef SIM_JITTER_MS
+#define SIM_JITTER_MS 2         // + [0 .. JITTER] per frame
+#endif
+#ifndef SIM_LOSS
+#define SIM_LOSS 2              // % lost between bursts
+#endif
+#ifndef SIM_BURST_START
+#define SIM_BURST_START 1       // % chance, per frame, of a burst starting
+#endif
+#ifndef SIM_BURST_END
+#define SIM_BURST_END 10        // % chance, per frame, of it ending
+#endif
+#ifndef SIM_BURST_LOSS
+#define SIM_BURST_LOSS 80       // % lost during a burst
+#endif
+#ifndef SIM_REORDER
+#define SIM_REORDER 2           // % held back SIM_REORDER_MS; later ones overtake
+#endif
+#ifndef SIM_REORDER_MS
+#define SIM_REORDER_MS 15
+#endif
+#ifndef SIM_DUPLICATE
+#define SIM_DUPLICATE 1         // % delivered twice
+#endif
+#ifndef SIM_OUTAGE_MS
+#define SIM_OUTAGE_MS 0         // the link goes dead this long ...
+#endif
+#define SIM_OUTAGE_PERIOD 10000 // ... every PERIOD ms; for timing failover
+// interference on a band of channels, like a nearby Wi-Fi network; it
+// shows up on the carrier detect too
+#ifndef SIM_BAND_LOSS
+#define SIM_BAND_LOSS 0         // % lost in the band
+#endif
+#define SIM_BAND_MIN 30
+#define SIM_BAND_MAX 52         // 22MHz, like one Wi-Fi channel
+
+// the simulated Chuck -- as Chuck.ino
+#define SIM_SAMPLE_MS 5         // TXMIT_INTERVAL
+#define SIM_HEARTBEAT 40        // TXMIT_HEARTBEAT
+#define SIM_RETRIES 2           // RADIO_RETRIES
+#define SIM_ACK_TIMEOUT 4       // RADIO_ACK_TIMEOUT
+#define SIM_PAIR_RETRY 50       // PAIR_RETRY
+#define SIM_TELEMETRY_MS 500    // TELEMETRY_INTERVAL
+#define SIM_HOP_HOME 1500       // HOP_HOME
+#define SIM_CHUCK_ADDRESS PAIR_CHUCK_MAX
+
+// ... and its rider: centered, then pushed for the last PUSH ms of
+// every PERIOD
+#define SIM_STICK_PERIOD 2500
+#define SIM_STICK_PUSH 1000
+#define SIM_STICK_CENTER 512
+#define SIM_STICK_PUSHED 912    // about +0.8
+
+#define SIM_IN_FLIGHT 8         // frames on their way; more are dropped
+#define SIM_STEPS 100           // stick pushes per report
+#define SIM_ESC_MOVING 0.05     // THROTTLE_MIN: the ESC has responded
+#define SIM_LATENCY_BUCKET 4    // ms per histogram bucket
+#define SIM_LATENCY_BUCKETS 64  // the last one is "longer"
+
+
+/*
+ * LinkBench: what the simulated link did, and what the rider would
+ * have felt -- the time from pushing the stick to the ESC responding
+ * (p50/p90/p99/max), how long the failsafe decayed and how often it
+ * tripped, and where the hop schedule spent its time.  Prints a report
+ * every SIM_STEPS pushes, then starts over.
+ *
+ * ex:
+ *   linkBench.escLevel(level, millis());   // the ESC was written
+ *   linkBench.decayMS ++;                  // per ms decaying
+ *   linkBench.tripped();                   // TF_FAILSAFE went up
+ *   linkBench.failedOver(ms);              // chuck.failovers went up
+ */
+class LinkBench {
+  private:
+    word histogram[SIM_LATENCY_BUCKETS];
+    word steps, maxLatency;
+    unsigned long pushedMS;
+    bool armed;
+    float lastLevel;
+
+
+    // upper edge of the bucket holding the pct'th percentile
+    word _percentile(byte pct) {
+      word want = ((unsigned long)steps * pct + 99) / 100;
+      word seen = 0;
+      for (byte i = 0; i < SIM_LATENCY_BUCKETS - 1; i++) {
+        seen += histogram[i];
+        if (seen >= want) {
+          return (i + 1) * SIM_LATENCY_BUCKET;
+        }
+      }
+      return maxLatency;
+    } // word _percentile(pct)
+
+
+  public:
+    // kept by VirtualNRF24
+    unsigned long sent, attempts, lost, reordered, duplicated, overflows, acks;
+    unsigned long offChannel, inBand, hops, homes;
+    // kept here, and by the host program
+    unsigned long skipped, missed, decayMS, trips, failovers, maxFailoverMS;
+
+
+    LinkBench() {
+      reset();
+      lastLevel = 0;
+    } // LinkBench()
+
+
+    void reset(void) {
+      for (byte i = 0; i < SIM_LATENCY_BUCKETS; i++) {
+        histogram[i] = 0;
+      }
+      steps = maxLatency = 0;
+      armed = false;
+      sent = attempts = lost = reordered = duplicated = overflows = acks = 0;
+      offChannel = inBand = hops = homes = 0;
+      skipped = missed = decayMS = trips = 0;
+      failovers = maxFailoverMS = 0;
+    } // reset()
+
+
+    // the rider pushed the stick at pushMS
+    void stickPushed(unsigned long pushMS) {
+      if (lastLevel >= SIM_ESC_MOVING) {
+        skipped ++;             // hadn't coasted down yet; can't tell
+        return;
+      }
+      pushedMS = pushMS;
+      armed = true;
+    } // stickPushed(pushMS)
+
+
+    // ... and let it go again
+    void stickReleased(void) {
+      if (armed) {
+        missed ++;              // the ESC never responded
+        armed = false;
+      }
+    } // stickReleased()
+
+
+    void escLevel(float level, unsigned long now) {
+      lastLevel = level;
+      if (! armed || level < SIM_ESC_MOVING) {
+        return;
+      }
+      armed = false;
+      word latency = now - pushedMS;
+      histogram[min(latency / SIM_LATENCY_BUCKET, SIM_LATENCY_BUCKETS - 1)] ++;
+      maxLatency = max(maxLatency, latency);
+      if (++steps == SIM_STEPS) {
+        report();
+        reset();
+      }
+    } // escLevel(level, now)
+
+
+    void tripped(void) {
+      trips ++;
+    } // tripped()
+
+
+    // switched input source (WIRED_CHUCK), ms after the old one's last frame
+    void failedOver(unsigned long ms) {
+      failovers ++;
+      maxFailoverMS = max(maxFailoverMS, ms);
+    } // failedOver(ms)
+
+
+    void report(void) {
+      #ifdef RADIO_STREAMING
+        printf("link (streaming): ");
+      #else
+        printf("link (reliable): ");
+      #endif
+      printf("%u pushes, stick->ESC p50 %ums, p90 %ums, p99 %ums, max %ums; missed %lu, skipped %lu\n",
+             steps, _percentile(50), _percentile(90), _percentile(99), maxLatency, missed, skipped);
+      printf("  frames %lu, attempts %lu, lost %lu, reordered %lu, duplicated %lu, overflowed %lu, "
+             "ACKs %lu, off channel %lu\n",
+             sent, attempts, lost, reordered, duplicated, overflows, acks, offChannel);
+      printf("  hops %lu, home %lu, %lu%% of attempts in the band; failsafe: %lums decayed, "
+             "%lu trips; %lu failovers, max %lums\n",
+             hops, homes, attempts ? inBand * 100 / attempts : 0, decayMS, trips,
+             failovers, maxFailoverMS);
+      fflush(stdout);
+    } // report()
+}; // class LinkBench
+
+LinkBench linkBench;
+
+
+struct SimFrame {
+  unsigned long arriveMS;
+  byte buf[CONTROL_FRAME_LONG_LEN];  // the longest frame
+  byte len, to, id, channel;
+};
+
+
+/*
+ * VirtualNRF24: the air around the board's RH_NRF24, with a simulated
+ * Chuck on the other side, so the whole receive path (the radio
+ * interrupt, manager, radio_recv, RadioQueue, Chuck, Failsafe,
+ * Throttle, the hop schedule) runs on a PC, repeatably.
+ *
+ * The Chuck pairs, then samples its rider's stick every SIM_SAMPLE_MS
+ * and transmits like the real one: on a change, else every
+ * SIM_HEARTBEAT; asking for telemetry every SIM_TELEMETRY_MS, echoing
+ * the channel it offers and hopping once that's through (ACKed;
+ * streaming, sent), going home after SIM_HOP_HOME without any.  Each
+ * transmission goes through the link:
+ *   loss: SIM_LOSS %, or SIM_BURST_LOSS % during a burst; bursts start
+ *     and end at random (Gilbert-Elliott); SIM_BAND_LOSS % more on
+ *     SIM_BAND_MIN .. SIM_BAND_MAX
+ *   latency: SIM_LATENCY_MS + [0 .. SIM_JITTER_MS]
+ *   reordering: SIM_REORDER % are held back another SIM_REORDER_MS
+ *   duplicates: SIM_DUPLICATE % arrive twice
+ *   outages: nothing at all for SIM_OUTAGE_MS every SIM_OUTAGE_PERIOD
+ *   channels: a frame only arrives if the board is listening on the
+ *     channel it was sent on, when it lands
+ * Reliable mode: a lost frame or lost ACK (same odds) is retried after
+ * SIM_ACK_TIMEOUT, up to SIM_RETRIES times, with the same header id --
+ * so the manager sees real retries and duplicates.  The ACK is settled
+ * as the frame is sent, as if the base were interrupt-driven; the ACKs
+ * the base actually sends are only counted.
+ *
+ * Simulated time only moves the Chuck when the board looks at the
+ * radio (available(), recv()): everything the Chuck would have done
+ * since then happens first.
+ *
+ * ex:
+ *   VirtualNRF24 air(driver);
+ *   bool RH_NRF24::available(void) { return air.available(); }
+ */
+class VirtualNRF24 {
+  private:
+    RH_NRF24& radio;
+    SimFrame inFlight[SIM_IN_FLIGHT];
+    byte flying;
+    SimFrame arrived;                 // what available() found
+    bool ready;
+    unsigned long chuckMS;            // how far the Chuck has got
+    unsigned long sentMS, requestMS, telemetryMS;
+    ControlFrame lastSent;
+    byte board, nextId;
+    byte channel, home, hopTo;        // the Chuck's
+    bool started, paired, pushed, bursting;
+
+
+    bool _inBand(byte channel) {
+      return channel >= SIM_BAND_MIN && channel <= SIM_BAND_MAX;
+    } // bool _inBand(channel)
+
+
+    // is this frame (or ACK) lost?  Moves the burst state along.
+    bool _lose(byte channel) {
+      if (bursting) {
+        bursting = random(100) >= SIM_BURST_END;
+      } else {
+        bursting = random(100) < SIM_BURST_START;
+      }
+      return random(100) < (bursting ? SIM_BURST_LOSS : SIM_LOSS)
+             || (_inBand(channel) && random(100) < SIM_BAND_LOSS);
+    } // bool _lose(channel)
+
+
+    void _land(byte *buf, byte len, byte to, byte id, unsigned long arriveMS) {
+      if (flying == SIM_IN_FLIGHT) {
+        linkBench.overflows ++;
+        return;
+      }
+      SimFrame *frame = &inFlight[flying++];
+      memcpy(frame->buf, buf, len);
+      frame->len = len;
+      frame->to = to;
+      frame->id = id;
+      frame->channel = channel;
+      frame->arriveMS = arriveMS;
+    } // _land(buf, len, to, id, arriveMS)
+
+
+    // one attempt; true if it got through
+    bool _fly(byte *buf, byte len, byte to, byte id, unsigned long sendMS) {
+      linkBench.attempts ++;
+      if (_inBand(channel)) {
+        linkBench.inBand ++;
+      }
+      if (_lose(channel) || sendMS % SIM_OUTAGE_PERIOD < SIM_OUTAGE_MS) {
+        linkBench.lost ++;
+        return false;
+      }
+      unsigned long arriveMS = sendMS + SIM_LATENCY_MS + random(SIM_JITTER_MS + 1);
+      if (random(100) < SIM_REORDER) {
+        linkBench.reordered ++;
+        arriveMS += SIM_REORDER_MS;
+      }
+      _land(buf, len, to, id, arriveMS);
+      if (random(100) < SIM_DUPLICATE) {
+        linkBench.duplicated ++;
+        _land(buf, len, to, id, arriveMS + 1 + random(SIM_JITTER_MS + 1));
+      }
+      return true;
+    } // bool _fly(buf, len, to, id, sendMS)
+
+
+    // true if it's through: ACKed (reliable) or sent (streaming)
+    bool _transmit(byte *buf, byte len, byte to, unsigned long sendMS) {
+      byte id = nextId++;
+      #ifdef RADIO_STREAMING
+        _fly(buf, len, to, id, sendMS);
+        return true;
+      #else
+        for (byte attempt = 0; attempt <= SIM_RETRIES; attempt++) {
+          if (_fly(buf, len, to, id, sendMS) && ! _lose(channel)) {
+            return true;        // ... and the ACK got back
+          }
+          sendMS += SIM_ACK_TIMEOUT;
+        }
+        return false;
+      #endif
+    } // bool _transmit(buf, len, to, sendMS)
+
+
+    // what the Chuck does every SIM_SAMPLE_MS
+    void _sample(unsigned long now) {
+      if (! paired) {
+        if (now - sentMS >= SIM_PAIR_RETRY) {
+          PairFrame request;
+          byte buf[PAIR_FRAME_LEN];
+          request.type = PAIR_REQUEST;
+          request.address = SIM_CHUCK_ADDRESS;
+          request.channel = 0;
+          encodePairFrame(&request, buf);
+          _transmit(buf, sizeof(buf), RH_BROADCAST_ADDRESS, now);
+          sentMS = now;
+        }
+        return;
+      }
+
+      word phase = now % SIM_STICK_PERIOD;
+      bool push = phase >= SIM_STICK_PERIOD - SIM_STICK_PUSH;
+      if (push != pushed) {
+        pushed = push;
+        if (push) {
+          // from when the rider moved, not when the Chuck noticed
+          linkBench.stickPushed(now - (phase - (SIM_STICK_PERIOD - SIM_STICK_PUSH)));
+        } else {
+          linkBench.stickReleased();
+        }
+      }
+
+      ControlFrame frame;
+      frame.stickX = SIM_STICK_CENTER;
+      frame.stickY = push ? SIM_STICK_PUSHED : SIM_STICK_CENTER;
+      frame.buttons = CF_ACTIVE;
+      frame.battery = 15;
+      // with TXMIT_THROTTLE, a Chuck which does no smoothing of its own
+      frame.throttle = push ? (long)THROTTLE_FRAME_SCALE * (SIM_STICK_PUSHED - SIM_STICK_CENTER) / 512 : 0;
+      if (frame.stickY == lastSent.stickY && now - sentMS < SIM_HEARTBEAT) {
+        return;
+      }
+      if (now - telemetryMS >= SIM_HOP_HOME && channel != home) {
+        channel = home;         // lost the hop schedule
+        hopTo = 0;
+        linkBench.homes ++;
+      }
+      frame.seq = lastSent.seq + 1;
+      lastSent = frame;
+      bool request = now - requestMS >= SIM_TELEMETRY_MS;
+      if (request) {
+        frame.buttons |= CF_TELEMETRY;
+        requestMS = now;
+      }
+      frame.extras = request || hopTo;
+      frame.stamp = frame.extras ? now : 0;
+      frame.hop = frame.extras ? hopTo : 0;
+      #ifdef TXMIT_THROTTLE
+        byte buf[THROTTLE_FRAME_LONG_LEN];
+        byte len = encodeThrottleFrame(&frame, buf);
+      #else
+        byte buf[CONTROL_FRAME_LONG_LEN];
+        byte len = encodeControlFrame(&frame, buf);
+      #endif
+      bool through = _transmit(buf, len, board, now);
+      sentMS = now;
+      linkBench.sent ++;
+      if (through && frame.hop) {
+        channel = frame.hop;    // the base has the echo
+        if (hopTo == frame.hop) {
+          hopTo = 0;
+        }
+        linkBench.hops ++;
+      }
+    } // _sample(now)
+
+
+    // catch the Chuck up to now
+    void _run(unsigned long now) {
+      if (! started) {
+        chuckMS = now;
+        started = true;
+      }
+      while ((long)(now - chuckMS) >= 0) {
+        _sample(chuckMS);
+        chuckMS += SIM_SAMPLE_MS;
+      }
+    } // _run(now)
+
+
+  public:
+    unsigned long heardMS;            // the board last took a frame
+
+
+    VirtualNRF24(RH_NRF24& radio) : radio(radio) {
+      flying = 0;
+      ready = started = paired = pushed = bursting = false;
+      sentMS = requestMS = telemetryMS = heardMS = 0;
+      lastSent.stickY = 0;
+      lastSent.seq = 0;
+      board = RH_BROADCAST_ADDRESS;
+      nextId = 0;
+      channel = home = PAIR_CHANNEL;
+      hopTo = 0;
+    } // VirtualNRF24(radio)
+
+
+    bool available(void) {
+      if (ready) {
+        return true;
+      }
+      unsigned long now = millis();
+      _run(now);
+      // what landed while the board was listening elsewhere is gone
+      for (byte i = 0; i < flying; ) {
+        if ((long)(now - inFlight[i].arriveMS) >= 0 && inFlight[i].channel != radio.channel()) {
+          linkBench.offChannel ++;
+          inFlight[i] = inFlight[--flying];
+        } else {
+          i ++;
+        }
+      }
+      byte first = flying;
+      for (byte i = 0; i < flying; i++) {
+        if ((long)(now - inFlight[i].arriveMS) >= 0
+            && (first == flying || (long)(inFlight[first].arriveMS - inFlight[i].arriveMS) > 0)) {
+          first = i;
+        }
+      }
+      if (first == flying) {
+        return false;
+      }
+      arrived = inFlight[first];
+      inFlight[first] = inFlight[--flying];
+      radio._rxHeaderTo = arrived.to;
+      radio._rxHeaderFrom = SIM_CHUCK_ADDRESS;
+      radio._rxHeaderId = arrived.id;
+      radio._rxHeaderFlags = RH_FLAGS_NONE;
+      ready = true;
+      return true;
+    } // bool available()
+
+
+    bool recv(uint8_t *buf, uint8_t *len) {
+      if (! available()) {
+        return false;
+      }
+      if (*len > arrived.len) {
+        *len = arrived.len;
+      }
+      memcpy(buf, arrived.buf, *len);
+      ready = false;
+      radio._rxGood ++;
+      heardMS = millis();
+      return true;
+    } // bool recv(buf, len)
+
+
+    // from the board: ACKs, telemetry, pairing
+    bool send(const uint8_t *data, uint8_t len) {
+      radio._txGood ++;
+      if (radio._txHeaderFlags & RH_FLAGS_ACK) {
+        linkBench.acks ++;
+        return true;
+      }
+      if (radio._txHeaderTo != SIM_CHUCK_ADDRESS || radio.channel() != channel || _lose(channel)) {
+        return true;
+      }
+      byte buf[TELEMETRY_FRAME_LEN];
+      memcpy(buf, data, min(len, sizeof(buf)));
+      if (len == PAIR_FRAME_LEN) {
+        PairFrame frame;
+        if (decodePairFrame(buf, &frame) && frame.type == PAIR_ACCEPT) {
+          board = frame.address;
+          channel = home = frame.channel;
+          telemetryMS = millis();
+          paired = true;
+        }
+      } else if (len == TELEMETRY_FRAME_LEN) {
+        TelemetryFrame frame;
+        if (decodeTelemetryFrame(buf, &frame)) {
+          telemetryMS = millis();
+          if (frame.channel != channel) {
+            hopTo = frame.channel;
+          }
+        }
+      }
+      return true;
+    } // bool send(data, len)
+
+
+    // carrier detect: the interference, if any
+    uint8_t spiReadRegister(uint8_t reg) {
+      return reg == RH_NRF24_REG_09_RPD && _inBand(radio.channel()) 
+             && random(100) < SIM_BAND_LOSS;
+    } // uint8_t spiReadRegister(reg)
+}; // class VirtualNRF24
+
+#endif
@@ -0,0 +1,184 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+/*
+ * The nunchuck activity test against a simulated hand: a chuck held
+ * with the stick pushed, its accelerometers at sigma LSB of noise per
+ * axis, centered on whole LSBs (the worst case: the stillest it reads).
+ * An hour of ticks per noise level; any tick it reads inactive is a
+ * false positive.  Then 20 freezes (a stuck link: the same frame over
+ * and over) and 20 unpluggings (no answer): the longest it took to
+ * read inactive.
+ *
+ * activity tests Nunchuck.h (the Chuck; the base's wired chuck),
+ * activity-classic the classic Wiiceiver's Chuck.h, each as its
+ * sketch reads it.
+ *
+ *   make activity activity-classic && ./activity && ./activity-classic
+ */
+
+#ifdef CLASSIC
+  #include "../Wiiceiver/Wiiceiver.ino"
+#else
+  #include <Wire.h>
+  #include "../Wiiceiver Surf/Wiiceiver_Base/ControlFrame.h"
+  #include "../Wiiceiver Surf/Wiiceiver_Base/WiredChuck.h"  // & Nunchuck.h
+  Nunchuck chuck;
+#endif
+
+#define ACT_HOUR_MS 3600000UL
+#define ACT_EVENTS 20
+#define ACT_STICK 200           // pushed: a thumb's on it
+
+
+// how a sketch reads the chuck: update() every tick, and sample()
+// every sampleMS in between (0: never)
+struct ReadPattern {
+  const char *name;
+  byte tickMS, sampleMS;
+};
+
+ReadPattern patterns[] = {
+  #ifdef CLASSIC
+    { "classic (tick, oversampled)", LOOP_MS, WII_SAMPLE_MS },
+    { "classic, not oversampling", LOOP_MS, 0 },
+  #else
+    { "Chuck, awake", 5, 0 },                   // TXMIT_INTERVAL
+    { "Chuck, powered down", 16, 0 },           // held(): it won't
+    { "base, wired chuck", 20, WIRED_SAMPLE_MS }, // LOOP_MS
+    { "base, wired, one read a tick", 20, 0 },
+  #endif
+};
+float sigmas[] = { 0.3, 0.5, 1.0 };
+
+
+// the hand, with its own PRNG (xorshift32) so the sketch's random()
+// doesn't move it
+uint32_t handState = 27;
+
+uint32_t handRandom(void) {
+  handState ^= handState << 13;
+  handState ^= handState >> 17;
+  handState ^= handState << 5;
+  return handState;
+} // uint32_t handRandom()
+
+
+// one N(0, 1) draw (Box-Muller)
+float noise(void) {
+  float u = (handRandom() + 1.0) / 4294967297.0, v = handRandom() / 4294967296.0;
+  return sqrtf(-2 * logf(u)) * cosf(2 * M_PI * v);
+} // float noise()
+
+
+float sigma;
+bool frozen, unplugged;
+byte lastFrame[6];
+
+int hand(byte *frame) {
+  if (unplugged) {
+    return 0;
+  }
+  if (! frozen) {
+    word ax = lroundf(512 + sigma * noise());
+    word ay = lroundf(512 + sigma * noise());
+    word az = lroundf(716 + sigma * noise());
+    byte fresh[6] = { 128, ACT_STICK, (byte)(ax >> 2), (byte)(ay >> 2), (byte)(az >> 2),
+                      (byte)((az & 3) << 6 | (ay & 3) << 4 | (ax & 3) << 2 | B11) };
+    memcpy(lastFrame, fresh, sizeof(lastFrame));
+  }
+  memcpy(frame, lastFrame, sizeof(lastFrame));
+  return 6;
+} // int hand(frame)
+
+
+// one tick, as the sketch spends it
+void tick(ReadPattern *p) {
+  unsigned long startMS = millis();
+  chuck.update();
+  if (p->sampleMS == 0) {
+    delay(p->tickMS);
+    return;
+  }
+  for (byte at = p->sampleMS; at < p->tickMS; at += p->sampleMS) {
+    delay(startMS + at - millis());
+    chuck.sample();
+  }
+  delay(startMS + p->tickMS - millis());
+} // tick(p)
+
+
+// ms from *fault going true to the chuck reading inactive, worst of
+// ACT_EVENTS; held normally for a random while in between
+unsigned long worstDetect(ReadPattern *p, bool *fault) {
+  unsigned long worst = 0;
+  for (int i = 0; i < ACT_EVENTS; i++) {
+    *fault = false;
+    unsigned long until = millis() + 1000 + handRandom() % 1000;
+    while (millis() < until || ! chuck.isActive()) {
+      tick(p);
+    }
+    *fault = true;
+    unsigned long faultMS = millis();
+    while (chuck.isActive()) {
+      tick(p);
+    }
+    worst = max(worst, millis() - faultMS);
+  }
+  *fault = false;
+  return worst;
+} // unsigned long worstDetect(p, fault)
+
+
+int main(void) {
+  hostNunchuck = hand;
+  printf("activity: %dms, %d reads; inactive while held (%% of ticks) / worst ms to "
+         "read a frozen, unplugged chuck inactive\n", WII_ACTIVITY_MS, WII_ACTIVITY_READS);
+  for (byte i = 0; i < sizeof(patterns) / sizeof(patterns[0]); i++) {
+    ReadPattern *p = &patterns[i];
+    printf("%-30s", p->name);
+    for (byte s = 0; s < sizeof(sigmas) / sizeof(sigmas[0]); s++) {
+      sigma = sigmas[s];
+      frozen = unplugged = false;
+      chuck.setup();
+      unsigned long ticks = 0, inactive = 0, endMS = millis() + ACT_HOUR_MS;
+      while (millis() < endMS) {
+        tick(p);
+        ticks ++;
+        inactive += ! chuck.isActive();
+      }
+      unsigned long frozenMS = worstDetect(p, &frozen);
+      unsigned long unpluggedMS = worstDetect(p, &unplugged);
+      printf("  %.1fLSB: %.4f%% / %lu, %lu", sigma, 100.0 * inactive / ticks,
+             frozenMS, unpluggedMS);
+    }
+    printf("\n");
+  }
+  return 0;
+} // main()
@@ -0,0 +1,64 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+/*
+ * Launch a Smoover from 0 to full at LOOP_MS on every accel profile:
+ * the peak jerk (the change in the throttle's rate, per second^2) and
+ * the time to full, for tuning THROTTLE_JERK.
+ *
+ *   make jerk && ./jerk 2>/dev/null
+ *   make -B jerk DEFS=-DTHROTTLE_JERK=0.4
+ */
+
+#include "../Wiiceiver Surf/Wiiceiver_Base/Wiiceiver_Base.ino"
+
+
+int main(void) {
+  float dt = LOOP_MS / 1000.0;
+  for (byte profile = 0; profile <= 6; profile++) {
+    Smoover launch(THROTTLE_RISE, THROTTLE_FALL, THROTTLE_SMOOTH, 
+                   THROTTLE_MIN_BUMP, THROTTLE_JERK);
+    launch.init(profileMultiplier(profile));
+    float value = 0, rate = 0, peakJerk = 0;
+    word steps = 0;
+    while (value < 1.0 && steps < 30.0 / dt) {
+      float next = launch.smoove(1.0, dt);
+      float change = (next - value) / dt - rate;
+      peakJerk = max(peakJerk, ABS(change) / dt);
+      rate += change;
+      value = next;
+      steps ++;
+    }
+    // ... and landing on it
+    peakJerk = max(peakJerk, rate / dt);
+    printf("launch, profile %d (x%.2f): peak jerk %.2f/s^2, full in %dms\n",
+           profile, profileMultiplier(profile), peakJerk, steps * LOOP_MS);
+  }
+  return 0;
+} // main()
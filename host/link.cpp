@@ -0,0 +1,124 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+/*
+ * The Surf base, on a PC, against a simulated Chuck and link
+ * (VirtualNRF24.h): stick-to-ESC latency, failsafe decay & trips,
+ * failover and the hop schedule, reported every SIM_STEPS pushes on
+ * stdout.  The sketch's own Serial output goes to stderr.
+ *
+ * The sketch runs as it would on the board: setup(), then loop()
+ * forever, with the radio interrupt taken every simulated ms that the
+ * radio has a frame and the sketch has it enabled.
+ *
+ *   make link && ./link 2>/dev/null
+ *   make link DEFS="-DRADIO_STREAMING -DSIM_LOSS=10"
+ */
+
+#include "../Wiiceiver Surf/Wiiceiver_Base/Wiiceiver_Base.ino"
+#include "VirtualNRF24.h"
+
+#ifndef SIM_RUN_S
+#define SIM_RUN_S 500           // simulated seconds; 200 pushes
+#endif
+
+
+VirtualNRF24 air(driver);
+
+bool RH_NRF24::available(void) {
+  return air.available();
+} // bool available()
+
+bool RH_NRF24::recv(uint8_t *buf, uint8_t *len) {
+  return air.recv(buf, len);
+} // bool recv(buf, len)
+
+bool RH_NRF24::send(const uint8_t *data, uint8_t len) {
+  return air.send(data, len);
+} // bool send(data, len)
+
+uint8_t RH_NRF24::spiReadRegister(uint8_t reg) {
+  return air.spiReadRegister(reg);
+} // uint8_t spiReadRegister(reg)
+
+
+// the ESC: what the rider feels
+void escWritten(int pin, int angle) {
+  if (pin == pinLocation(ESC_PPM_ID)) {
+    float level = (angle - ESC_CENTER) / (float)(ESC_MAX_ANGLE - ESC_CENTER);
+    linkBench.escLevel(level, millis());
+  }
+} // escWritten(pin, angle)
+
+
+// every simulated ms: the radio interrupt, and watching the sketch
+void hostEveryMS(void) {
+  static bool failsafe = false;
+  static word failovers = 0;
+  unsigned long now = millis();
+
+  #ifdef RADIO_IRQ_PIN
+    if (hostInterrupts && (PCICR & (1 << PCIE1)) && air.available()) {
+      hostPins[RADIO_IRQ_PIN] = LOW;
+      PCINT1_vect();
+      hostPins[RADIO_IRQ_PIN] = HIGH;
+      hostInterrupts = true;    // reti
+    }
+  #endif
+
+  if (chuck.isActive() && failsafeStage(chuck.age()) == FAILSAFE_DECAYING) {
+    linkBench.decayMS ++;
+  }
+  bool tripped = telemetry.faults & TF_FAILSAFE;
+  if (tripped && ! failsafe) {
+    linkBench.tripped();
+  }
+  failsafe = tripped;
+  if (chuck.failovers != failovers) {
+    failovers = chuck.failovers;
+    if (chuck.source == INPUT_WIRED) {
+      linkBench.failedOver(now - air.heardMS);
+    } else {
+      linkBench.failovers ++;   // back to the radio
+    }
+  }
+
+  if (now >= SIM_RUN_S * 1000UL) {
+    exit(0);
+  }
+} // hostEveryMS()
+
+
+int main(void) {
+  hostServoWritten = escWritten;
+  setup();
+  for (;;) {
+    loop();
+  }
+} // main()
@@ -0,0 +1,108 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+/*
+ * Every accel profile on a simulated board & rider (BoardModel.h), at
+ * LOOP_MS: 0-20km/h, stopping distance, peak jerk and stick-to-motion
+ * latency.
+ *
+ *   make profiles && ./profiles 2>/dev/null
+ */
+
+#include "../Wiiceiver Surf/Wiiceiver_Base/Wiiceiver_Base.ino"
+#include "BoardModel.h"
+
+
+// one accel profile, at LOOP_MS: the rider goes full stick from a
+// standstill, and at 20km/h full brake to a stop.  Jerk is the change
+// in the board's acceleration, tick to tick; latency runs from the
+// stick leaving center to the board doing 1km/h.
+void rideProfile(byte profile) {
+  BoardModel board;
+  Rider rider;
+  float dt = LOOP_MS / 1000.0;
+  float accel = 0, peakJerk = 0, brakeFrom = 0;
+  long stickMS = -1, movingMS = -1, to20MS = -1, stoppedMS = -1;
+  throttle.setProfile(profileMultiplier(profile));
+  throttle.zero();
+  rider.decide(1.0);
+  for (word i = 0; i < 60.0 / dt && stoppedMS < 0; i++) {
+    float stick = rider.update(dt);
+    float value = throttle.update(ControlInput(0, stick, false, false), dt);
+    float from = board.speed;
+    for (byte ms = 0; ms < LOOP_MS; ms++) {
+      board.step(value, 0.001);
+    }
+    float next = (board.speed - from) / dt;
+    if (board.speed > 0) {
+      // not the stop itself: the model's brakes let go all at once
+      peakJerk = max(peakJerk, fabs(next - accel) / dt);
+    }
+    accel = next;
+
+    long ms = (long)(i + 1) * LOOP_MS;
+    if (stickMS < 0 && stick != 0) {
+      stickMS = ms - LOOP_MS;
+    }
+    if (movingMS < 0 && board.speed >= 1 / 3.6) {
+      movingMS = ms;
+    }
+    if (to20MS < 0 && board.speed >= 20 / 3.6) {
+      to20MS = ms;
+      brakeFrom = board.distance;
+      rider.decide(-1.0);
+    } else if (to20MS >= 0 && board.speed == 0) {
+      stoppedMS = ms;
+    }
+  }
+  printf("profile %d (x%.2f): 0-20km/h %.2fs, stopped in %.1fm / %.2fs, peak jerk %.1fm/s^3, "
+         "stick to motion %ldms\n",
+         profile, profileMultiplier(profile), to20MS < 0 ? -1 : (to20MS - stickMS) / 1000.0,
+         stoppedMS < 0 ? -1 : board.distance - brakeFrom,
+         stoppedMS < 0 ? -1 : (stoppedMS - to20MS) / 1000.0, peakJerk, movingMS - stickMS);
+} // rideProfile(profile)
+
+
+// stamped with the version, so runs can be compared across firmware
+void benchmarkProfiles(void) {
+  printf("profiles, v %s\n", WSB_VERSION);
+  for (byte profile = 0; profile <= 6; profile++) {
+    rideProfile(profile);
+  }
+  throttle.setProfile(getProfileMultiplier());
+  throttle.zero();
+} // benchmarkProfiles()
+
+
+int main(void) {
+  readSettings();
+  throttle.init();
+  benchmarkProfiles();
+  return 0;
+} // main()
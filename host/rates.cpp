@@ -0,0 +1,77 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+/*
+ * The Surf throttle at several loop rates: a full-stick push for 15s,
+ * then let go for 1s.  Its rates are per second, so the times to 50%
+ * and 90% of full, and back under 10% on release, should match to
+ * within a tick at 50, 100, 200 and 500Hz.
+ *
+ *   make rates && ./rates 2>/dev/null
+ */
+
+#include "../Wiiceiver Surf/Wiiceiver_Base/Wiiceiver_Base.ino"
+
+
+// full stick for 15s, then let go for 1s, at dt; print how long the 
+// throttle takes to get to 50% / 90% of its peak, and back under 10%
+void replayRate(float dt) {
+  throttle.zero();
+  float peak = 0;
+  int to50 = -1, to90 = -1, to10 = -1;
+  int pushSteps = 15.0 / dt, steps = 16.0 / dt;
+  for (int i = 0; i < steps; i++) {
+    ControlInput stick(0, (i < pushSteps ? 1.0 : 0.0), false, false);
+    float value = throttle.update(stick, dt);
+    int ms = (i + 1) * dt * 1000;
+    peak = max(peak, value);
+    if (to50 < 0 && value >= 0.5 * throttle.getMaxThrottle()) {
+      to50 = ms;
+    }
+    if (to90 < 0 && value >= 0.9 * throttle.getMaxThrottle()) {
+      to90 = ms;
+    }
+    if (i >= pushSteps && to10 < 0 && value < 0.1 * peak) {
+      to10 = ms - pushSteps * dt * 1000;
+    }
+  }
+  printf("replay @ %.0fHz: peak %.3f, 50%% in %dms, 90%% in %dms, released <10%% in %dms\n",
+         1.0 / dt, peak, to50, to90, to10);
+} // replayRate(dt)
+
+
+int main(void) {
+  readSettings();
+  throttle.init();
+  replayRate(0.020);
+  replayRate(0.010);
+  replayRate(0.005);
+  replayRate(0.002);
+  return 0;
+} // main()
@@ -0,0 +1,89 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+/*
+ * A fixed, seeded replay through the throttle: 200k ticks of random
+ * sticks, C/Z and loop times (5 & 20ms), and a hash of every output.
+ * For refactors which mustn't change the ride: build it before and
+ * after (same seed, same flags), and the hashes should match.  -v
+ * prints every value instead.
+ *
+ *   make replay replay-classic && ./replay && ./replay-classic
+ *   git stash; make -B replay; ./replay; git stash pop
+ */
+
+#ifdef CLASSIC
+  #include "../Wiiceiver/Wiiceiver.ino"
+#else
+  #include "../Wiiceiver Surf/Wiiceiver_Base/Wiiceiver_Base.ino"
+#endif
+
+#define REPLAY_TICKS 200000L
+#define REPLAY_SEED 42
+
+
+int main(int argc, char **argv) {
+  bool verbose = argc > 1 && ! strcmp(argv[1], "-v");
+  uint32_t hash = 2166136261UL;         // FNV-1a, over the floats' bytes
+  float x = 0, y = 0;
+  bool c = false, z = false;
+
+  #ifndef CLASSIC
+    readSettings();
+  #endif
+  throttle.init();
+  randomSeed(REPLAY_SEED);
+  for (long i = 0; i < REPLAY_TICKS; i++) {
+    if (random(25) == 0) {
+      x = random(-1000, 1001) / 1000.0;
+      y = random(-1000, 1001) / 1000.0;
+      byte buttons = random(10);
+      c = buttons == 0 || buttons == 2;
+      z = buttons == 1 || buttons == 2;
+    }
+    float dt = random(2) ? 0.020 : 0.005;
+    float value = throttle.update(ControlInput(x, y, c, z), dt);
+    if (verbose) {
+      printf("%.9g\n", value);
+    }
+    const byte *bytes = (const byte *)&value;
+    for (byte b = 0; b < sizeof(value); b++) {
+      hash = (hash ^ bytes[b]) * 16777619UL;
+    }
+  }
+  if (! verbose) {
+    #ifdef CLASSIC
+      printf("classic throttle: ");
+    #else
+      printf("Surf throttle: ");
+    #endif
+    printf("%ld ticks, output hash %08lx\n", REPLAY_TICKS, (unsigned long)hash);
+  }
+  return 0;
+} // main()
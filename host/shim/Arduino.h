@@ -0,0 +1,191 @@
+/*
+ * Just enough of the Arduino core (AVR flavour) to build the sketches
+ * on a PC.  Time is simulated: it only moves in delay() and
+ * delayMicroseconds(), and by a microsecond per millis() / micros()
+ * call, so a busy-wait still finishes.  Every simulated ms the
+ * program's hostEveryMS() hook runs, which is where a host program
+ * plays the world: radio interrupts, reports, the end of the run.
+ *
+ * Serial goes to stderr, so stdout carries only what the host program
+ * itself reports.
+ */
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "binary.h"
+
+typedef uint8_t byte;
+typedef uint16_t word;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+#define LED_BUILTIN 13
+#define HOST_PINS 22
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define PROGMEM
+#define F(x) (x)
+
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#define constrain(a,l,h) ((a)<(l)?(l):((a)>(h)?(h):(a)))
+#define abs(x) ((x)>0?(x):-(x))
+#define bitRead(v,b) (((v)>>(b))&1)
+#define _BV(b) (1<<(b))
+#define bit_is_set(r,b) ((r)&_BV(b))
+#define bit_is_clear(r,b) (!((r)&_BV(b)))
+#define lowByte(w) ((uint8_t)((w) & 0xff))
+#define highByte(w) ((uint8_t)((w) >> 8))
+inline word makeWord(uint8_t h, uint8_t l) { return (h << 8) | l; }
+#define word(...) makeWord(__VA_ARGS__)
+
+
+// time
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// pins: what digitalRead() / analogRead() see; set them from the host
+// program.  Digital pins read HIGH until then, analog ones 0.
+extern byte hostPins[HOST_PINS];
+extern int hostAnalog[HOST_PINS];
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int value);
+int digitalRead(int pin);
+int analogRead(int pin);
+void analogWrite(int pin, int value);
+void attachInterrupt(int irq, void (*isr)(void), int mode);
+void detachInterrupt(int irq);
+int digitalPinToInterrupt(int pin);
+
+// interrupts: a flag the host program checks before "interrupting"
+extern bool hostInterrupts;
+void noInterrupts(void);
+void interrupts(void);
+void cli(void);
+void sei(void);
+
+// a fixed-seed PRNG, so every run is the same
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+
+class HardwareSerial {
+  public:
+    void begin(long baud) {}
+    int available(void) { return 0; }
+    int read(void) { return -1; }
+    void flush(void) { fflush(stderr); }
+
+    void print(const char *s) { fputs(s, stderr); }
+    void print(char c) { fputc(c, stderr); }
+    void print(unsigned char n, int base = DEC) { print((unsigned long)n, base); }
+    void print(int n, int base = DEC) { print((long)n, base); }
+    void print(unsigned int n, int base = DEC) { print((unsigned long)n, base); }
+    void print(long n, int base = DEC);
+    void print(unsigned long n, int base = DEC);
+    void print(double n, int digits = 2) { fprintf(stderr, "%.*f", digits, n); }
+
+    void println(void) { fputc('\n', stderr); }
+    template<class T> void println(T x) { print(x); println(); }
+    template<class T> void println(T x, int format) { print(x, format); println(); }
+};
+extern HardwareSerial Serial;
+
+
+// the registers the sketches touch; plain memory here
+extern volatile uint8_t SREG, PCICR, PCMSK0, PCMSK1, PCMSK2, PCIFR, EIMSK, EICRA;
+extern volatile uint8_t TCCR1A, TCCR1B, TIMSK1, ADCSRA, ADMUX, ACSR, MCUSR, WDTCSR, PRR, SMCR;
+extern volatile uint8_t PIND;
+extern volatile uint16_t ICR1, TCNT1, OCR1A, ADC;
+extern volatile unsigned long timer0_millis;
+
+#define PCIE0 0
+#define PCIE1 1
+#define PCIE2 2
+#define PCIF0 0
+#define PCIF1 1
+#define PCIF2 2
+#define PCINT0 0
+#define PCINT1 1
+#define PCINT2 2
+#define PCINT3 3
+#define PCINT8 0
+#define PCINT9 1
+#define PCINT10 2
+#define PCINT18 2
+#define PCINT19 3
+#define PCINT20 4
+#define PCINT23 7
+#define PIND7 7
+#define ICES1 6
+#define ICNC1 7
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define ICIE1 5
+#define TOIE1 0
+#define ADEN 7
+#define ADSC 6
+#define ACD 7
+#define REFS0 6
+#define REFS1 7
+#define MUX0 0
+#define MUX1 1
+#define MUX2 2
+#define MUX3 3
+#define WDCE 4
+#define WDE 3
+#define WDIE 6
+#define WDP0 0
+#define WDP1 1
+#define WDP2 2
+#define WDP3 5
+#define WDRF 3
+
+// an ISR is an ordinary function; the host program calls it
+#define ISR(vector) extern "C" void vector(void)
+extern "C" void PCINT1_vect(void);
+extern "C" void PCINT2_vect(void);
+extern "C" void WDT_vect(void);
+
+// for RamReport.h
+extern char __heap_start, *__brkval;
+
+
+// the host program's, if it wants one: called once per simulated ms
+// (never re-entered)
+void hostEveryMS(void);
+
+#endif
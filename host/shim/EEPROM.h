@@ -0,0 +1,19 @@
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#include <Arduino.h>
+
+// 1KB, like an ATmega328's
+class EEPROMClass {
+  private:
+    byte cells[1024];
+
+  public:
+    EEPROMClass();
+    byte read(int address) { return cells[address & 1023]; }
+    void write(int address, byte value) { cells[address & 1023] = value; }
+    void update(int address, byte value) { write(address, value); }
+};
+extern EEPROMClass EEPROM;
+
+#endif
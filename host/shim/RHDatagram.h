@@ -0,0 +1,59 @@
+#ifndef RHDATAGRAM_H
+#define RHDATAGRAM_H
+
+#include <RHGenericDriver.h>
+
+// RadioHead's addressed datagrams, as of 1.23
+class RHDatagram {
+  public:
+    RHDatagram(RHGenericDriver& driver, uint8_t thisAddress = 0) : _driver(driver) {
+      _thisAddress = thisAddress;
+    }
+
+    bool init(void) {
+      bool ok = _driver.init();
+      if (ok) {
+        setThisAddress(_thisAddress);
+      }
+      return ok;
+    }
+
+    void setThisAddress(uint8_t thisAddress) {
+      _driver.setThisAddress(thisAddress);
+      _driver.setHeaderFrom(thisAddress);
+      _thisAddress = thisAddress;
+    }
+
+    uint8_t thisAddress(void) { return _thisAddress; }
+    bool available(void) { return _driver.available(); }
+    bool waitPacketSent(void) { return _driver.waitPacketSent(); }
+    void setHeaderTo(uint8_t to) { _driver.setHeaderTo(to); }
+    void setHeaderFrom(uint8_t from) { _driver.setHeaderFrom(from); }
+    void setHeaderId(uint8_t id) { _driver.setHeaderId(id); }
+    void setHeaderFlags(uint8_t set, uint8_t clear = RH_FLAGS_APPLICATION_SPECIFIC) {
+      _driver.setHeaderFlags(set, clear);
+    }
+
+    bool sendto(uint8_t *buf, uint8_t len, uint8_t address) {
+      setHeaderTo(address);
+      return _driver.send(buf, len);
+    }
+
+    bool recvfrom(uint8_t *buf, uint8_t *len, uint8_t *from = NULL, uint8_t *to = NULL,
+                  uint8_t *id = NULL, uint8_t *flags = NULL) {
+      if (! _driver.recv(buf, len)) {
+        return false;
+      }
+      if (from) *from = _driver.headerFrom();
+      if (to) *to = _driver.headerTo();
+      if (id) *id = _driver.headerId();
+      if (flags) *flags = _driver.headerFlags();
+      return true;
+    }
+
+  protected:
+    RHGenericDriver& _driver;
+    uint8_t _thisAddress;
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef RHGENERICDRIVER_H
+#define RHGENERICDRIVER_H
+
+#include <Arduino.h>
+
+// RadioHead's driver base class, as of 1.23: the header bytes and
+// counters; the driver does the rest
+#define RH_BROADCAST_ADDRESS 0xff
+#define RH_FLAGS_NONE 0x00
+#define RH_FLAGS_ACK 0x80
+#define RH_FLAGS_APPLICATION_SPECIFIC 0x0f
+
+class RHGenericDriver {
+  public:
+    typedef enum { RHModeInitialising, RHModeSleep, RHModeIdle, RHModeTx, RHModeRx } RHMode;
+
+    RHGenericDriver() {
+      _mode = RHModeInitialising;
+      _thisAddress = RH_BROADCAST_ADDRESS;
+      _txHeaderTo = RH_BROADCAST_ADDRESS;
+      _txHeaderFrom = RH_BROADCAST_ADDRESS;
+      _txHeaderId = _txHeaderFlags = 0;
+      _rxHeaderTo = _rxHeaderFrom = _rxHeaderId = _rxHeaderFlags = 0;
+      _rxBad = _rxGood = _txGood = 0;
+      _promiscuous = false;
+    }
+    virtual ~RHGenericDriver() {}
+
+    virtual bool init(void) { return true; }
+    virtual bool available(void) = 0;
+    virtual bool recv(uint8_t *buf, uint8_t *len) = 0;
+    virtual bool send(const uint8_t *data, uint8_t len) = 0;
+    virtual bool waitPacketSent(void) { return true; }
+    virtual uint8_t maxMessageLength(void) = 0;
+
+    void setThisAddress(uint8_t address) { _thisAddress = address; }
+    void setHeaderTo(uint8_t to) { _txHeaderTo = to; }
+    void setHeaderFrom(uint8_t from) { _txHeaderFrom = from; }
+    void setHeaderId(uint8_t id) { _txHeaderId = id; }
+    void setHeaderFlags(uint8_t set, uint8_t clear = RH_FLAGS_APPLICATION_SPECIFIC) {
+      _txHeaderFlags &= ~clear;
+      _txHeaderFlags |= set;
+    }
+    uint8_t headerTo(void) { return _rxHeaderTo; }
+    uint8_t headerFrom(void) { return _rxHeaderFrom; }
+    uint8_t headerId(void) { return _rxHeaderId; }
+    uint8_t headerFlags(void) { return _rxHeaderFlags; }
+    void setPromiscuous(bool promiscuous) { _promiscuous = promiscuous; }
+    RHMode mode(void) { return _mode; }
+    void setModeIdle(void) { _mode = RHModeIdle; }
+    uint16_t rxBad(void) { return _rxBad; }
+    uint16_t rxGood(void) { return _rxGood; }
+    uint16_t txGood(void) { return _txGood; }
+
+  protected:
+    volatile RHMode _mode;
+    uint8_t _thisAddress;
+    bool _promiscuous;
+    volatile uint8_t _rxHeaderTo, _rxHeaderFrom, _rxHeaderId, _rxHeaderFlags;
+    uint8_t _txHeaderTo, _txHeaderFrom, _txHeaderId, _txHeaderFlags;
+    volatile uint16_t _rxBad, _rxGood, _txGood;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef RHRELIABLEDATAGRAM_H
+#define RHRELIABLEDATAGRAM_H
+
+#include <RHDatagram.h>
+
+// RadioHead's acknowledged datagrams, as of 1.23: the receiving side
+// (ACKs and duplicate suppression).  sendtoWait() sends once and
+// trusts it; nothing on the host waits for an ACK.
+class RHReliableDatagram : public RHDatagram {
+  public:
+    RHReliableDatagram(RHGenericDriver& driver, uint8_t thisAddress = 0)
+      : RHDatagram(driver, thisAddress) {
+      memset(_seenIds, 0, sizeof(_seenIds));
+      _lastSequenceNumber = 0;
+      _retries = 3;
+      _timeout = 200;
+    }
+
+    void setTimeout(uint16_t timeout) { _timeout = timeout; }
+    void setRetries(uint8_t retries) { _retries = retries; }
+    uint32_t retransmissions(void) { return 0; }
+
+    bool sendtoWait(uint8_t *buf, uint8_t len, uint8_t address) {
+      setHeaderId(++_lastSequenceNumber);
+      setHeaderFlags(RH_FLAGS_NONE, RH_FLAGS_ACK);
+      return sendto(buf, len, address);
+    }
+
+    bool recvfromAck(uint8_t *buf, uint8_t *len, uint8_t *from = NULL, uint8_t *to = NULL,
+                     uint8_t *id = NULL, uint8_t *flags = NULL) {
+      uint8_t _from, _to, _id, _flags;
+      if (available() && recvfrom(buf, len, &_from, &_to, &_id, &_flags)) {
+        if (! (_flags & RH_FLAGS_ACK)) {
+          if (_to == _thisAddress) {
+            acknowledge(_id, _from);
+          }
+          if (_id != _seenIds[_from]) {
+            if (from) *from = _from;
+            if (to) *to = _to;
+            if (id) *id = _id;
+            if (flags) *flags = _flags;
+            _seenIds[_from] = _id;
+            return true;
+          }
+        }
+      }
+      return false;
+    }
+
+  protected:
+    void acknowledge(uint8_t id, uint8_t from) {
+      setHeaderId(id);
+      setHeaderFlags(RH_FLAGS_ACK);
+      uint8_t ack = '!';
+      sendto(&ack, sizeof(ack), from);
+      waitPacketSent();
+    }
+
+  private:
+    uint8_t _seenIds[256];
+    uint8_t _lastSequenceNumber;
+    uint8_t _retries;
+    uint16_t _timeout;
+};
+
+#endif
@@ -0,0 +1,23 @@
+/*
+ * An NRF24 in an empty room: sends go nowhere, nothing arrives, no
+ * carrier anywhere.  For the host programs with no link to simulate.
+ */
+
+#include <RH_NRF24.h>
+
+bool RH_NRF24::available(void) {
+  return false;
+} // bool available()
+
+bool RH_NRF24::recv(uint8_t *buf, uint8_t *len) {
+  return false;
+} // bool recv(buf, len)
+
+bool RH_NRF24::send(const uint8_t *data, uint8_t len) {
+  _txGood ++;
+  return true;
+} // bool send(data, len)
+
+uint8_t RH_NRF24::spiReadRegister(uint8_t reg) {
+  return 0;
+} // uint8_t spiReadRegister(reg)
@@ -0,0 +1,46 @@
+#ifndef RH_NRF24_H
+#define RH_NRF24_H
+
+#include <RHGenericDriver.h>
+
+#define RH_NRF24_MAX_MESSAGE_LEN 28
+#define RH_NRF24_REG_00_CONFIG 0x00
+#define RH_NRF24_REG_07_STATUS 0x07
+#define RH_NRF24_REG_09_RPD 0x09
+#define RH_NRF24_REG_1C_DYNPD 0x1c
+#define RH_NRF24_REG_1D_FEATURE 0x1d
+#define RH_NRF24_RX_DR 0x40
+#define RH_NRF24_TX_DS 0x20
+#define RH_NRF24_MAX_RT 0x10
+#define RH_NRF24_EN_ACK_PAY 0x02
+
+// the radio: the header bytes, the channel, and declarations.  What it
+// hears is up to the host program -- RH_NRF24.cpp is an empty room;
+// link/VirtualNRF24.h is a Chuck on a lossy link.
+class RH_NRF24 : public RHGenericDriver {
+  friend class VirtualNRF24;
+
+  private:
+    uint8_t _channel;
+
+  public:
+    typedef enum { DataRate1Mbps, DataRate2Mbps, DataRate250kbps } DataRate;
+    typedef enum { TransmitPowerm18dBm, TransmitPowerm12dBm, TransmitPowerm6dBm, TransmitPower0dBm } TransmitPower;
+
+    RH_NRF24(uint8_t chipEnablePin = 8, uint8_t slaveSelectPin = 10) { _channel = 2; }
+    bool available(void);
+    bool recv(uint8_t *buf, uint8_t *len);
+    bool send(const uint8_t *data, uint8_t len);
+    uint8_t spiReadRegister(uint8_t reg);
+    uint8_t maxMessageLength(void) { return RH_NRF24_MAX_MESSAGE_LEN; }
+    bool setChannel(uint8_t channel) { _channel = channel; return true; }
+    uint8_t channel(void) { return _channel; }
+    bool setRF(DataRate rate, TransmitPower power) { return true; }
+    bool sleep(void) { _mode = RHModeSleep; return true; }
+    bool powerUp(void) { _mode = RHModeIdle; return true; }
+    void setModeRx(void) { _mode = RHModeRx; }
+    void setModeTx(void) { _mode = RHModeTx; }
+    uint8_t spiWriteRegister(uint8_t reg, uint8_t value) { return 0; }
+};
+
+#endif
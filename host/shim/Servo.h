@@ -0,0 +1,20 @@
+#ifndef SERVO_H
+#define SERVO_H
+
+#include <Arduino.h>
+
+class Servo {
+  private:
+    int us;
+
+  public:
+    Servo() { us = 1500; }
+    void attach(int pin) {}
+    void attach(int pin, int minUS, int maxUS) {}
+    void write(int angle) { us = map(angle, 0, 180, 544, 2400); }
+    void writeMicroseconds(int us) { this->us = us; }
+    int read(void) { return map(us, 544, 2400, 0, 180); }
+    int readMicroseconds(void) { return us; }
+};
+
+#endif
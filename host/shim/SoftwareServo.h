@@ -0,0 +1,22 @@
+#ifndef SOFTWARESERVO_H
+#define SOFTWARESERVO_H
+
+#include <Arduino.h>
+
+// set it to see every angle written (e.g. the ESC's)
+extern void (*hostServoWritten)(int pin, int angle);
+
+class SoftwareServo {
+  private:
+    int pin, angle;
+
+  public:
+    SoftwareServo() { pin = -1; angle = 0; }
+    void attach(int pin) { this->pin = pin; }
+    void detach(void) { pin = -1; }
+    void write(int angle);
+    int read(void) { return angle; }
+    static void refresh(void) {}
+};
+
+#endif
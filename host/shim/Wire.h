@@ -0,0 +1,30 @@
+#ifndef WIRE_H
+#define WIRE_H
+
+#include <Arduino.h>
+
+// I2C, with a simulated nunchuck on the other end (see arduino.cpp)
+class TwoWire {
+  private:
+    byte buffer[6];
+    byte length, at;
+
+  public:
+    TwoWire() { length = at = 0; }
+    void begin(void) {}
+    void setClock(long hz) {}
+    void beginTransmission(int address) {}
+    int write(int value) { return 1; }
+    int endTransmission(bool stop = true) { return 0; }
+    int requestFrom(int address, int quantity);
+    int requestFrom(int address, int quantity, bool stop) { return requestFrom(address, quantity); }
+    int available(void) { return length - at; }
+    int read(void) { return at < length ? buffer[at++] : -1; }
+};
+extern TwoWire Wire;
+
+// the host program's nunchuck, if it wants one: fill in frame, return
+// how many bytes it answered with (0: unplugged)
+extern int (*hostNunchuck)(byte *frame);
+
+#endif
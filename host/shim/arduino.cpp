@@ -0,0 +1,201 @@
+/*
+ * The host shim's Arduino core: simulated time, pins, Serial, and the
+ * libraries' state (EEPROM, Wire, SoftwareServo).
+ */
+
+#include "Arduino.h"
+#include "EEPROM.h"
+#include "Wire.h"
+#include "SoftwareServo.h"
+
+
+// time, in simulated microseconds
+static unsigned long hostUS = 0;
+static bool inHook = false;
+
+void __attribute__((weak)) hostEveryMS(void) {}
+
+static void hostAdvance(unsigned long us) {
+  unsigned long fromMS = hostUS / 1000;
+  hostUS += us;
+  for (unsigned long ms = fromMS; ms < hostUS / 1000 && ! inHook; ms++) {
+    inHook = true;
+    hostEveryMS();
+    inHook = false;
+  }
+} // hostAdvance(us)
+
+unsigned long millis(void) {
+  hostAdvance(1);
+  return hostUS / 1000;
+} // unsigned long millis()
+
+unsigned long micros(void) {
+  hostAdvance(1);
+  return hostUS;
+} // unsigned long micros()
+
+void delay(unsigned long ms) {
+  while (ms-- > 0) {
+    hostAdvance(1000);
+  }
+} // delay(ms)
+
+void delayMicroseconds(unsigned int us) {
+  hostAdvance(us);
+} // delayMicroseconds(us)
+
+
+// pins
+byte hostPins[HOST_PINS];
+int hostAnalog[HOST_PINS];
+static bool pinsReady = false;
+
+static void readyPins(void) {
+  if (! pinsReady) {
+    memset(hostPins, HIGH, sizeof(hostPins));
+    pinsReady = true;
+  }
+} // readyPins()
+
+void pinMode(int pin, int mode) {
+  readyPins();
+} // pinMode(pin, mode)
+
+void digitalWrite(int pin, int value) {
+  readyPins();
+  if (pin >= 0 && pin < HOST_PINS) {
+    hostPins[pin] = value;
+  }
+} // digitalWrite(pin, value)
+
+int digitalRead(int pin) {
+  readyPins();
+  return pin >= 0 && pin < HOST_PINS ? hostPins[pin] : LOW;
+} // int digitalRead(pin)
+
+int analogRead(int pin) {
+  return pin >= A0 && pin < HOST_PINS ? hostAnalog[pin] : 0;
+} // int analogRead(pin)
+
+void analogWrite(int pin, int value) {}
+void attachInterrupt(int irq, void (*isr)(void), int mode) {}
+void detachInterrupt(int irq) {}
+int digitalPinToInterrupt(int pin) { return pin == 2 ? 0 : pin == 3 ? 1 : -1; }
+
+
+// interrupts
+bool hostInterrupts = true;
+void noInterrupts(void) { hostInterrupts = false; }
+void interrupts(void) { hostInterrupts = true; }
+void cli(void) { hostInterrupts = false; }
+void sei(void) { hostInterrupts = true; }
+
+extern "C" void __attribute__((weak)) PCINT1_vect(void) {}
+extern "C" void __attribute__((weak)) PCINT2_vect(void) {}
+extern "C" void __attribute__((weak)) WDT_vect(void) {}
+
+
+// xorshift32
+static uint32_t hostRandom = 2463534242UL;
+
+long random(long howbig) {
+  if (howbig <= 0) {
+    return 0;
+  }
+  hostRandom ^= hostRandom << 13;
+  hostRandom ^= hostRandom >> 17;
+  hostRandom ^= hostRandom << 5;
+  return hostRandom % howbig;
+} // long random(howbig)
+
+long random(long howsmall, long howbig) {
+  return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall);
+} // long random(howsmall, howbig)
+
+void randomSeed(unsigned long seed) {
+  if (seed != 0) {
+    hostRandom = seed;
+  }
+} // randomSeed(seed)
+
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+} // long map(x, inMin, inMax, outMin, outMax)
+
+
+// Serial
+HardwareSerial Serial;
+
+void HardwareSerial::print(long n, int base) {
+  if (n < 0 && base == DEC) {
+    fputc('-', stderr);
+    n = -n;
+  }
+  print((unsigned long)n, base);
+} // print(n, base)
+
+void HardwareSerial::print(unsigned long n, int base) {
+  char buf[8 * sizeof(long) + 1];
+  char *at = &buf[sizeof(buf) - 1];
+  *at = 0;
+  do {
+    byte digit = n % base;
+    *--at = digit < 10 ? '0' + digit : 'A' + digit - 10;
+    n /= base;
+  } while (n > 0);
+  fputs(at, stderr);
+} // print(n, base)
+
+
+// registers
+volatile uint8_t SREG, PCICR, PCMSK0, PCMSK1, PCMSK2, PCIFR, EIMSK, EICRA;
+volatile uint8_t TCCR1A, TCCR1B, TIMSK1, ADCSRA, ADMUX, ACSR, MCUSR, WDTCSR, PRR, SMCR;
+volatile uint8_t PIND;
+volatile uint16_t ICR1, TCNT1, OCR1A, ADC;
+volatile unsigned long timer0_millis;
+char __heap_start, *__brkval;
+
+
+// EEPROM: blank, as from the factory
+EEPROMClass EEPROM;
+
+EEPROMClass::EEPROMClass() {
+  memset(cells, 0xFF, sizeof(cells));
+} // EEPROMClass()
+
+
+// Wire: a nunchuck at 0x52, stick centered, buttons up, held in a
+// hand (a couple of LSB of accelerometer noise) -- unless the host
+// program plays it
+TwoWire Wire;
+int (*hostNunchuck)(byte *frame) = NULL;
+
+int TwoWire::requestFrom(int address, int quantity) {
+  byte frame[6];
+  int got = 6;
+  if (hostNunchuck) {
+    got = hostNunchuck(frame);
+  } else {
+    word ax = 512 + random(-2, 3), ay = 512 + random(-2, 3), az = 716 + random(-2, 3);
+    byte still[6] = { 128, 128, (byte)(ax >> 2), (byte)(ay >> 2), (byte)(az >> 2),
+                      (byte)((az & 3) << 6 | (ay & 3) << 4 | (ax & 3) << 2 | B11) };
+    memcpy(frame, still, sizeof(frame));
+  }
+  length = min(quantity, got);
+  memcpy(buffer, frame, length);
+  at = 0;
+  return length;
+} // int requestFrom(address, quantity)
+
+
+// SoftwareServo: the host program can watch what's written
+void (*hostServoWritten)(int pin, int angle) = NULL;
+
+void SoftwareServo::write(int angle) {
+  this->angle = angle;
+  if (hostServoWritten) {
+    hostServoWritten(pin, angle);
+  }
+} // write(angle)
@@ -0,0 +1,6 @@
+#ifndef AVR_INTERRUPT_H
+#define AVR_INTERRUPT_H
+
+#include <Arduino.h>
+
+#endif
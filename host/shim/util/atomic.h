@@ -0,0 +1,9 @@
+#ifndef UTIL_ATOMIC_H
+#define UTIL_ATOMIC_H
+
+#include <Arduino.h>
+
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_BLOCK(type) for (bool _once = (noInterrupts(), true); _once; _once = (interrupts(), false))
+
+#endif
@@ -0,0 +1,99 @@
+/*
+ * (CC BY-NC-SA 4.0) 
+ * http://creativecommons.org/licenses/by-nc-sa/4.0/
+ *
+ * WARNING WARNING WARNING: attaching motors to a *board is 
+ * a terribly dangerous thing to do.  This software is totally
+ * for amusement and/or educational purposes.  Don't obtain or
+ * make a wiiceiver (see below for instructions and parts), 
+ * don't attach it to a skateboard, and CERTAINLY don't use it
+ * to zip around with just a tiny, ergonomic nunchuck instead
+ * of a bulky R/C controller.
+ *
+ * This software is made freely available.  If you wish to 
+ * sell it, don't.  If you wish to modify it, DO! (and please
+ * let me know).  Much of the code is derived from others out
+ * there, I've made attributuions where appropriate.
+ *
+ * http://austindavid.com/wiiceiver
+ *  
+ * latest software: https://github.com/jaustindavid/wiiceiver
+ *
+ * Enjoy!  Be safe! 
+ * 
+ * (CC BY-NC-SA 4.0) Austin David, austin@austindavid.com
+ * 20 Feb 2015
+ *
+ */
+
+
+/*
+ * The closed-loop speed hold (SpeedHold.h) on a simulated board
+ * (BoardModel.h) with a simulated wheel sensor: push to ~5m/s, then
+ * hold C for 10s each on the flat, a 5% climb and a 5% descent.
+ *
+ *   make speedhold && ./speedhold 2>/dev/null
+ */
+
+#include "../Wiiceiver Surf/Wiiceiver_Base/Wiiceiver_Base.ino"
+#include "BoardModel.h"
+
+
+// one LOOP_MS tick of the simulated board at value, in 1ms steps;
+// every WHEEL_MM_PER_PULSE it rolls is an edge on wheel, at simUS
+void rideTick(BoardModel& board, WheelSpeed& wheel, float value, unsigned long& simUS) {
+  for (byte ms = 0; ms < LOOP_MS; ms++) {
+    float from = board.distance * 1000;
+    board.step(value, 0.001);
+    float to = board.distance * 1000;
+    float edge = (floor(from / WHEEL_MM_PER_PULSE) + 1) * WHEEL_MM_PER_PULSE;
+    for (; edge <= to; edge += WHEEL_MM_PER_PULSE) {
+      wheel.pulse(simUS + (edge - from) / (to - from) * 1000);
+    }
+    simUS += 1000;
+  }
+} // rideTick(board, wheel, value, simUS)
+
+
+// push a simulated board to ~5m/s, then hold C for 10s each on the
+// flat, a 5% climb and a 5% descent: how far the speed wanders from
+// where C caught it, and the throttle that took
+void benchmarkSpeedHold(void) {
+  const float grades[] = { 0, 0.05, -0.05 };
+  BoardModel board;
+  WheelSpeed sim;                     // the model's, not the interrupt's
+  unsigned long simUS = 0;
+  float dt = LOOP_MS / 1000.0;
+  throttle.zero();
+  for (word i = 0; i < 5.0 / dt; i++) {
+    throttle.setSpeed(sim.mmps(simUS));
+    rideTick(board, sim, throttle.update(ControlInput(0, 0.5, false, false), dt), simUS);
+  }
+  float held = board.speed * 1000;
+  for (byte s = 0; s < 3; s++) {
+    board.grade = grades[s];
+    float worst = 0, sum = 0, lo = 1, hi = -1;
+    word ticks = 10.0 / dt;
+    for (word i = 0; i < ticks; i++) {
+      throttle.setSpeed(sim.mmps(simUS));
+      float value = throttle.update(ControlInput(0, 0, true, false), dt);
+      rideTick(board, sim, value, simUS);
+      float error = fabs(board.speed * 1000 - held);
+      worst = max(worst, error);
+      sum += error;
+      lo = min(lo, value);
+      hi = max(hi, value);
+    }
+    printf("speed hold, grade %.0f%%: %.0fmm/s, error avg %.0f max %.0fmm/s, throttle %.2f .. %.2f\n",
+           grades[s] * 100, held, sum / ticks, worst, lo, hi);
+  }
+  throttle.zero();
+} // benchmarkSpeedHold()
+
+
+int main(void) {
+  readSettings();
+  throttle.init();
+  benchmarkSpeedHold();
+  return 0;
+} // main()